@@ -0,0 +1,195 @@
+#ifndef Array_h
+#define Array_h
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "Math.h"
+
+// header-only expression templates over CustomMath arrays
+//
+//   CustomMath::Array<double> a(n), b(n), c(n), out(n);
+//   out = a * b + exp(c);
+//
+// the right hand side only builds a tree of references, nothing is computed until it is assigned
+// assignment then walks the arrays in blocks small enough to stay in L1:
+//   1. every exp node evaluates its operand for the block and runs the batch CustomMath::exp on it,
+//      so exp gets the SIMD kernels of Math.h instead of a scalar call per element
+//   2. one fused loop evaluates the rest of the tree, element by element, and vectorizes
+// no temporary arrays and no heap allocations (when out already has the right size)
+// assigning to an operand of the expression is fine, every element only reads its own index
+
+namespace CustomMath {
+    // base of every node, E is the node type itself
+    template <typename E>
+    struct Expression {
+        const E &self() const { return static_cast<const E &>(*this); }
+        std::size_t size() const { return self().size(); }
+    };
+
+    namespace Inner {
+        // elements per block, the exp buffers of an expression live on the stack
+        constexpr std::size_t array_block = 256;
+    }
+
+    template <typename T>
+    class Array : public Expression<Array<T>> {
+    public:
+        Array() = default;
+        explicit Array(std::size_t n, T value = T()) : data_(n, value) {}
+
+        // evaluating into a new array allocates once, for the array itself
+        template <typename E>
+        Array(const Expression<E> &e) : data_(e.size()) { assign(e.self()); }
+
+        template <typename E>
+        Array &operator=(const Expression<E> &e) {
+            if (data_.size() != e.size())
+                data_.resize(e.size());
+            assign(e.self());
+            return *this;
+        }
+
+        std::size_t size() const { return data_.size(); }
+        T operator[](std::size_t i) const { return data_[i]; }
+        T &operator[](std::size_t i) { return data_[i]; }
+        T *data() { return data_.data(); }
+        const T *data() const { return data_.data(); }
+        T *begin() { return data_.data(); }
+        T *end() { return data_.data() + data_.size(); }
+        const T *begin() const { return data_.data(); }
+        const T *end() const { return data_.data() + data_.size(); }
+
+        // nothing to precompute for a leaf
+        void prepare(std::size_t, std::size_t) const {}
+
+    private:
+        template <typename E>
+        void assign(const E &expr) {
+            T *out = data_.data();
+            const std::size_t n = data_.size();
+            for (std::size_t start = 0; start < n; start += Inner::array_block) {
+                const std::size_t end = start + Inner::array_block < n ? start + Inner::array_block : n;
+                expr.prepare(start, end - start);
+                // the fused loop
+                for (std::size_t i = start; i < end; ++i)
+                    out[i] = expr[i];
+            }
+        }
+
+        std::vector<T> data_;
+    };
+
+    namespace Inner {
+        // a constant operand, broadcast to every index
+        template <typename T>
+        struct Scalar : Expression<Scalar<T>> {
+            T value;
+            std::size_t n;
+            Scalar(T v, std::size_t size) : value(v), n(size) {}
+            std::size_t size() const { return n; }
+            T operator[](std::size_t) const { return value; }
+            void prepare(std::size_t, std::size_t) const {}
+        };
+
+        // arrays are held by reference, every other node by value
+        template <typename E>
+        struct Operand { using type = const E; };
+        template <typename T>
+        struct Operand<Array<T>> { using type = const Array<T> &; };
+
+        template <typename E>
+        using ValueOf = decltype(std::declval<const E &>()[0]);
+
+        template <typename L, typename R, typename Op>
+        struct Binary : Expression<Binary<L, R, Op>> {
+            typename Operand<L>::type l;
+            typename Operand<R>::type r;
+            Binary(const L &left, const R &right) : l(left), r(right) {
+                assert(left.size() == right.size() && "CustomMath::Array operands differ in size");
+            }
+            std::size_t size() const { return l.size(); }
+            auto operator[](std::size_t i) const { return Op::apply(l[i], r[i]); }
+            void prepare(std::size_t start, std::size_t n) const {
+                l.prepare(start, n);
+                r.prepare(start, n);
+            }
+        };
+
+        struct Add { template <typename T> static T apply(T a, T b) { return a + b; } };
+        struct Sub { template <typename T> static T apply(T a, T b) { return a - b; } };
+        struct Mult { template <typename T> static T apply(T a, T b) { return a * b; } };
+        struct Div { template <typename T> static T apply(T a, T b) { return a / b; } };
+
+        template <typename E>
+        struct Negate : Expression<Negate<E>> {
+            typename Operand<E>::type e;
+            explicit Negate(const E &operand) : e(operand) {}
+            std::size_t size() const { return e.size(); }
+            auto operator[](std::size_t i) const { return -e[i]; }
+            void prepare(std::size_t start, std::size_t n) const { e.prepare(start, n); }
+        };
+
+        // exp is computed a block at a time by the batch function, the fused loop reads the block back
+        template <typename E>
+        struct Exp : Expression<Exp<E>> {
+            using T = ValueOf<E>;
+            typename Operand<E>::type e;
+            mutable T block[array_block];
+            mutable std::size_t offset = 0;
+
+            explicit Exp(const E &operand) : e(operand) {}
+            std::size_t size() const { return e.size(); }
+            T operator[](std::size_t i) const { return block[i - offset]; }
+            void prepare(std::size_t start, std::size_t n) const {
+                e.prepare(start, n);
+                for (std::size_t i = 0; i < n; ++i)
+                    block[i] = e[start + i];
+                CustomMath::exp(block, block, n);
+                offset = start;
+            }
+        };
+    }
+
+#define CUSTOMMATH_ARRAY_OPERATOR(op, Node)                                                              \
+    template <typename L, typename R>                                                                    \
+    Inner::Binary<L, R, Inner::Node> operator op(const Expression<L> &l, const Expression<R> &r) {      \
+        return {l.self(), r.self()};                                                                     \
+    }                                                                                                    \
+    template <typename L>                                                                                \
+    Inner::Binary<L, Inner::Scalar<Inner::ValueOf<L>>, Inner::Node> operator op(                        \
+        const Expression<L> &l, Inner::ValueOf<L> r) {                                                   \
+        return {l.self(), {r, l.size()}};                                                                \
+    }                                                                                                    \
+    template <typename R>                                                                                \
+    Inner::Binary<Inner::Scalar<Inner::ValueOf<R>>, R, Inner::Node> operator op(                        \
+        Inner::ValueOf<R> l, const Expression<R> &r) {                                                   \
+        return {{l, r.size()}, r.self()};                                                                \
+    }
+
+    CUSTOMMATH_ARRAY_OPERATOR(+, Add)
+    CUSTOMMATH_ARRAY_OPERATOR(-, Sub)
+    CUSTOMMATH_ARRAY_OPERATOR(*, Mult)
+    CUSTOMMATH_ARRAY_OPERATOR(/, Div)
+
+#undef CUSTOMMATH_ARRAY_OPERATOR
+
+    template <typename E>
+    Inner::Negate<E> operator-(const Expression<E> &e) { return Inner::Negate<E>(e.self()); }
+
+    template <typename E>
+    Inner::Exp<E> exp(const Expression<E> &e) { return Inner::Exp<E>(e.self()); }
+
+    // named versions, matching the scalar CustomMath::add/sub/mult/div
+    template <typename L, typename R>
+    auto add(const Expression<L> &l, const Expression<R> &r) { return l + r; }
+    template <typename L, typename R>
+    auto sub(const Expression<L> &l, const Expression<R> &r) { return l - r; }
+    template <typename L, typename R>
+    auto mult(const Expression<L> &l, const Expression<R> &r) { return l * r; }
+    template <typename L, typename R>
+    auto div(const Expression<L> &l, const Expression<R> &r) { return l / r; }
+}
+
+#endif
@@ -7,6 +7,18 @@
 
 namespace CustomMath
 {
+#ifdef USE_MATH
+    double add(double a, double b) { return Inner::add(a, b); }
+    double sub(double a, double b) { return Inner::sub(a, b); }
+    double mult(double a, double b) { return Inner::mult(a, b); }
+    double div(double a, double b) { return Inner::div(a, b); }
+#else
+    double add(double a, double b) { return a + b; }
+    double sub(double a, double b) { return a - b; }
+    double mult(double a, double b) { return a * b; }
+    double div(double a, double b) { return a / b; }
+#endif
+
     double exp(double x)
     {
 #ifdef USE_MATH
@@ -16,6 +28,97 @@ namespace CustomMath
 #endif
     }
 
+#ifdef USE_MATH
+    double exp_correctly_rounded(double x) { return Inner::exp_correctly_rounded(x); }
+    double exp_fast(double x) { return Inner::exp_fast(x); }
+    double exp_float(double x) { return Inner::exp_float(x); }
+#else
+    // without the custom implementation every tier is std::exp
+    double exp_correctly_rounded(double x) { return std::exp(x); }
+    double exp_fast(double x) { return std::exp(x); }
+    double exp_float(double x) { return std::exp(x); }
+#endif
+
+    void exp(const double *in, double *out, std::size_t n)
+    {
+#ifdef USE_MATH
+        Inner::exp(in, out, n);
+#else
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::exp(in[i]);
+#endif
+    }
+
+    void exp(const float *in, float *out, std::size_t n)
+    {
+#ifdef USE_MATH
+        Inner::exp(in, out, n);
+#else
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::exp(in[i]);
+#endif
+    }
+
+#ifdef USE_MATH
+    double sum(const double *in, std::size_t n, Summation strategy) { return Inner::sum(in, n, strategy); }
+    float sum(const float *in, std::size_t n, Summation strategy) { return Inner::sum(in, n, strategy); }
+    double dot(const double *a, const double *b, std::size_t n, Summation strategy) { return Inner::dot(a, b, n, strategy); }
+    float dot(const float *a, const float *b, std::size_t n, Summation strategy) { return Inner::dot(a, b, n, strategy); }
+    double mean(const double *in, std::size_t n, Summation strategy) { return Inner::mean(in, n, strategy); }
+    float mean(const float *in, std::size_t n, Summation strategy) { return Inner::mean(in, n, strategy); }
+#else
+    // without the custom implementation every strategy is the naive loop
+    template <typename T>
+    T naive_sum(const T *in, std::size_t n)
+    {
+        T s = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            s += in[i];
+        return s;
+    }
+
+    template <typename T>
+    T naive_dot(const T *a, const T *b, std::size_t n)
+    {
+        T s = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            s += a[i] * b[i];
+        return s;
+    }
+
+    double sum(const double *in, std::size_t n, Summation) { return naive_sum(in, n); }
+    float sum(const float *in, std::size_t n, Summation) { return naive_sum(in, n); }
+    double dot(const double *a, const double *b, std::size_t n, Summation) { return naive_dot(a, b, n); }
+    float dot(const float *a, const float *b, std::size_t n, Summation) { return naive_dot(a, b, n); }
+    double mean(const double *in, std::size_t n, Summation) { return n ? naive_sum(in, n) / double(n) : std::nan(""); }
+    float mean(const float *in, std::size_t n, Summation) { return n ? naive_sum(in, n) / float(n) : std::nanf(""); }
+#endif
+
+    const char *simd_tier()
+    {
+#ifdef USE_MATH
+        return Inner::simd_tier();
+#else
+        return "std";
+#endif
+    }
+
+    void set_num_threads([[maybe_unused]] int n)
+    {
+#ifdef USE_MATH
+        Inner::set_num_threads(n);
+#endif
+    }
+
+    int num_threads()
+    {
+#ifdef USE_MATH
+        return Inner::num_threads();
+#else
+        return 1;
+#endif
+    }
+
     double print_generated() {
 #ifdef USE_MATH
         return Inner::print_generated();
@@ -1,6 +1,8 @@
 #ifndef Math_h
 #define Math_h
 
+#include <cstddef>
+
 #if defined(_WIN32)
 #  if defined(EXPORTING_MATH)
 #    define DECLSPEC __declspec(dllexport)
@@ -12,8 +14,61 @@
 #endif
 
 namespace CustomMath {
+    // accuracy tiers of exp<Precision>, the error is measured against the exactly rounded result
+    //   CorrectlyRounded  0 ulp, the exactly rounded result for every input
+    //   Accurate          1 ulp, the default and what exp(double) returns
+    //   Fast              4 ulp
+    //   Float             1 ulp of float (2^29 ulp of double), over the whole double range
+    enum class Precision { CorrectlyRounded, Accurate, Fast, Float };
+
+    // strategies of sum, dot and mean, from the fastest to the most accurate
+    // u is the unit roundoff of the element type, S the sum of the absolute values of the terms
+    //   Naive        one accumulator in order, error up to (n - 1) u S
+    //   Simd         16 independent accumulators kept in vector registers, error up to (n / 16 + 4) u S
+    //   Pairwise     blocks of 128 elements combined pairwise, error up to (log2(n) + 16) u S, the default
+    //   Compensated  Neumaier's variant of Kahan summation, error about 2 u |result| whatever n is,
+    //                dot also adds the rounding error of every product
+    enum class Summation { Naive, Simd, Pairwise, Compensated };
+
+    double DECLSPEC add(double, double);
+    double DECLSPEC sub(double, double);
+    double DECLSPEC mult(double, double);
+    double DECLSPEC div(double, double);
     double DECLSPEC exp(double);
+    double DECLSPEC exp_correctly_rounded(double);
+    double DECLSPEC exp_fast(double);
+    double DECLSPEC exp_float(double);
+    // CustomMath::exp<Precision::Fast>(x), resolved at compile time to the kernel of the tier
+    template <Precision P = Precision::Accurate>
+    inline double exp(double x) {
+        if constexpr (P == Precision::CorrectlyRounded)
+            return exp_correctly_rounded(x);
+        else if constexpr (P == Precision::Fast)
+            return exp_fast(x);
+        else if constexpr (P == Precision::Float)
+            return exp_float(x);
+        else
+            return exp(x);
+    }
+    // batch versions, out[i] = e^in[i] for i < n
+    // in and out may be the same array but must not partially overlap
+    void DECLSPEC exp(const double *in, double *out, std::size_t n);
+    void DECLSPEC exp(const float *in, float *out, std::size_t n);
+    // reductions, the sum of in[i], the sum of a[i] * b[i] and sum / n (NaN when n is 0)
+    double DECLSPEC sum(const double *in, std::size_t n, Summation strategy = Summation::Pairwise);
+    float DECLSPEC sum(const float *in, std::size_t n, Summation strategy = Summation::Pairwise);
+    double DECLSPEC dot(const double *a, const double *b, std::size_t n, Summation strategy = Summation::Pairwise);
+    float DECLSPEC dot(const float *a, const float *b, std::size_t n, Summation strategy = Summation::Pairwise);
+    double DECLSPEC mean(const double *in, std::size_t n, Summation strategy = Summation::Pairwise);
+    float DECLSPEC mean(const float *in, std::size_t n, Summation strategy = Summation::Pairwise);
+    // name of the instruction set tier the batch functions run on, chosen when the library loads
+    // CUSTOMMATH_ISA=scalar|sse2|avx2|avx512 in the environment caps the tier
+    DECLSPEC const char *simd_tier();
+    // batch calls over large arrays are split across up to this many threads (OpenMP builds only)
+    // n <= 0 restores the default, the OpenMP maximum (OMP_NUM_THREADS)
+    void DECLSPEC set_num_threads(int n);
+    int DECLSPEC num_threads();
     double DECLSPEC print_generated();
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,62 @@
+# hardware introspection for Tuning.h
+#
+# runs introspect.cxx on the build machine once, and caches what it printed
+# every value can be set on the command line instead, which is the only source when cross-compiling:
+#   cmake -DTUNING_CACHE_LINE=128 -DTUNING_L2=1048576 -DTUNING_SIMD="sse2;avx2" ...
+# empty values are detected, values the machine cannot report fall back to the defaults below
+# delete TUNING_DETECTED from the cache (or the cache itself) to detect again
+
+set(TUNING_CACHE_LINE "" CACHE STRING "Cache line size in bytes (empty: detect)")
+set(TUNING_L1D "" CACHE STRING "L1 data cache size in bytes (empty: detect)")
+set(TUNING_L2 "" CACHE STRING "L2 cache size in bytes (empty: detect)")
+set(TUNING_LLC "" CACHE STRING "Last level cache size in bytes (empty: detect)")
+set(TUNING_HUGE_PAGE "" CACHE STRING "Huge page size in bytes, 0 without huge pages (empty: detect)")
+set(TUNING_SIMD "" CACHE STRING "Instruction sets of the target CPU, e.g. sse2;avx2;avx512 (empty: detect)")
+
+if(NOT DEFINED TUNING_DETECTED)
+    set(detected "")
+    if(CMAKE_CROSSCOMPILING AND NOT CMAKE_CROSSCOMPILING_EMULATOR)
+        message(STATUS "Tuning: cross-compiling, set the TUNING_* cache variables for the target")
+    else()
+        try_run(introspect_run introspect_compile
+            ${CMAKE_CURRENT_BINARY_DIR}/introspect
+            ${CMAKE_CURRENT_LIST_DIR}/introspect.cxx
+            CMAKE_FLAGS -DCMAKE_CXX_STANDARD=17
+            RUN_OUTPUT_VARIABLE detected
+        )
+        if(NOT introspect_compile OR NOT introspect_run EQUAL 0)
+            message(STATUS "Tuning: introspect.cxx failed, using defaults")
+            set(detected "")
+        endif()
+    endif()
+    # one KEY=VALUE per line, a cache entry cannot hold newlines
+    string(REPLACE "\n" "|" detected "${detected}")
+    set(TUNING_DETECTED "${detected}" CACHE INTERNAL "Output of introspect.cxx")
+endif()
+
+# a detected value, unless the cache variable overrides it or the machine did not report it
+function(tuning_value name default)
+    set(value "${default}")
+    if(NOT "${TUNING_${name}}" STREQUAL "")
+        set(value "${TUNING_${name}}")
+    elseif(TUNING_DETECTED MATCHES "(^|\\|)${name}=([^|]*)")
+        # CMAKE_MATCH_2 only exists after the match, it cannot be tested in the same condition
+        if(NOT "${CMAKE_MATCH_2}" STREQUAL "" AND NOT "${CMAKE_MATCH_2}" STREQUAL "0")
+            set(value "${CMAKE_MATCH_2}")
+        endif()
+    endif()
+    set(tuning_${name} "${value}" PARENT_SCOPE)
+endfunction()
+
+# common x86 values, so that an unknown machine still gets sensible blocking
+tuning_value(CACHE_LINE 64)
+tuning_value(L1D 32768)
+tuning_value(L2 262144)
+tuning_value(LLC 8388608)
+tuning_value(HUGE_PAGE 0)
+tuning_value(SIMD "")
+
+message(STATUS "Tuning: cache line ${tuning_CACHE_LINE} B, L1d ${tuning_L1D} B, L2 ${tuning_L2} B, "
+               "LLC ${tuning_LLC} B, huge page ${tuning_HUGE_PAGE} B, SIMD '${tuning_SIMD}'")
+
+configure_file(${CMAKE_CURRENT_LIST_DIR}/Tuning.h.in ${CMAKE_CURRENT_BINARY_DIR}/Tuning.h)
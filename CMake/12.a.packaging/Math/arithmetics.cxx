@@ -1,19 +1,80 @@
 #include "Math.h"
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include "Generated.h"
+#include "arithmetics.h"
+#include "exp_kernels.h"
+#include "parallel.h"
 
 namespace CustomMath {
     // note the addition of the Inner namespace
     namespace Inner {
-        double exp(double a) {
-            #ifdef EXP_AVAILABLE
-            return std::exp(a);
-            #else
-            return 0;
-            #endif
+        double add(double a, double b) { return a + b; }
+        double sub(double a, double b) { return a - b; }
+        double mult(double a, double b) { return a * b; }
+        double div(double a, double b) { return a / b; }
+
+        namespace {
+            // table-driven, the tables are generated at build time into Generated.h (see write_number_to_file.cxx)
+            // the tiers share the reduction and the table and differ in the polynomial and in the use of the low table part
+            template <int degree, bool low_part>
+            inline double exp_table(double a, const double *poly) {
+                using namespace Generated;
+
+                // NaN fails both comparisons and is returned as is
+                if (!(a < Kernels::max_input))
+                    return a > 0 ? HUGE_VAL : a;
+                if (a < Kernels::min_input)
+                    return 0;
+
+                // a = k * ln2 / N + r, k = e * N + j
+                double kd = (a * exp_inv_step + Kernels::shifter) - Kernels::shifter;
+                double r = (a - kd * exp_step_hi) - kd * exp_step_lo;
+                std::int64_t k = static_cast<std::int64_t>(kd);
+                std::int64_t j = k & (exp_table_size - 1);
+                std::int64_t e = (k - j) / exp_table_size;
+
+                // q = exp(r) - 1, added to the low part of the table entry first to keep its extra bits
+                double q = poly[degree];
+                for (int i = degree - 1; i > 0; --i)
+                    q = q * r + poly[i];
+                q *= r;
+                double t = low_part ? exp_table_hi[j] + (exp_table_lo[j] + exp_table_hi[j] * q)
+                                    : exp_table_hi[j] + exp_table_hi[j] * q;
+
+                // 2^e in two halves, so that subnormal results round only once
+                std::int64_t e1 = e / 2;
+                std::uint64_t b1 = static_cast<std::uint64_t>(e1 + 1023) << 52;
+                std::uint64_t b2 = static_cast<std::uint64_t>(e - e1 + 1023) << 52;
+                double s1, s2;
+                std::memcpy(&s1, &b1, sizeof(double));
+                std::memcpy(&s2, &b2, sizeof(double));
+                return t * s1 * s2;
+            }
+        }
+
+        double exp(double a) { return exp_table<Generated::exp_poly_degree, true>(a, Generated::exp_poly); }
+
+        // the low table part is below half an ulp, dropping it costs at most that much
+        double exp_fast(double a) { return exp_table<Generated::exp_poly_fast_degree, false>(a, Generated::exp_poly_fast); }
+
+        double exp_float(double a) { return exp_table<Generated::exp_poly_float_degree, false>(a, Generated::exp_poly_float); }
+
+        // exp_correctly_rounded is in exp_precise.cxx
+
+        // the kernels are picked at runtime (see dispatch.cxx), large arrays are split across threads (see parallel.cxx)
+        void exp(const double *in, double *out, std::size_t n) {
+            Parallel::run(Kernels::dispatch().exp_double, in, out, n);
         }
 
+        void exp(const float *in, float *out, std::size_t n) {
+            Parallel::run(Kernels::dispatch().exp_float, in, out, n);
+        }
+
+        const char *simd_tier() { return Kernels::dispatch().name; }
+
         double print_generated() { return GENERATED_CONSTANT; }
     }
 
-}
\ No newline at end of file
+}
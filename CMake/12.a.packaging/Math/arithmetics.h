@@ -1,11 +1,32 @@
 # ifndef arithmetics_h
 # define arithmetics_h
 
+#include <cstddef>
+#include "Math.h"
+
 namespace CustomMath {
     namespace Inner {
+        double add(double, double);
+        double sub(double, double);
+        double mult(double, double);
+        double div(double, double);
         double exp(double);
+        double exp_correctly_rounded(double);
+        double exp_fast(double);
+        double exp_float(double);
+        void exp(const double *, double *, std::size_t);
+        void exp(const float *, float *, std::size_t);
+        double sum(const double *, std::size_t, Summation);
+        float sum(const float *, std::size_t, Summation);
+        double dot(const double *, const double *, std::size_t, Summation);
+        float dot(const float *, const float *, std::size_t, Summation);
+        double mean(const double *, std::size_t, Summation);
+        float mean(const float *, std::size_t, Summation);
+        const char *simd_tier();
+        void set_num_threads(int);
+        int num_threads();
         double print_generated();
     }
 }
 
-# endif
\ No newline at end of file
+# endif
@@ -0,0 +1,84 @@
+#include "exp_kernels.h"
+
+// AVX-512F, 8 doubles or 16 floats per register
+// the tail is handled with a masked load/store instead of the scalar loop
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Kernels {
+            namespace {
+                inline __m512d exp_pd(__m512d x) {
+                    x = _mm512_min_pd(_mm512_set1_pd(max_input), x);
+                    x = _mm512_max_pd(_mm512_set1_pd(min_input), x);
+
+                    const __m512d shift = _mm512_set1_pd(shifter);
+                    __m512d k = _mm512_sub_pd(_mm512_fmadd_pd(x, _mm512_set1_pd(log2e), shift), shift);
+                    __m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(ln2_hi), x);
+                    r = _mm512_fnmadd_pd(k, _mm512_set1_pd(ln2_lo), r);
+
+                    __m512d p = _mm512_set1_pd(poly[poly_degree]);
+                    for (int i = poly_degree - 1; i >= 0; --i) {
+                        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(poly[i]));
+                    }
+
+                    __m512d k1 = _mm512_sub_pd(_mm512_fmadd_pd(k, _mm512_set1_pd(0.5), shift), shift);
+                    __m512i b1 = _mm512_castpd_si512(_mm512_add_pd(k1, shift));
+                    __m512i b2 = _mm512_castpd_si512(_mm512_add_pd(_mm512_sub_pd(k, k1), shift));
+                    const __m512i bias = _mm512_set1_epi64(1023);
+                    __m512d s1 = _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(b1, bias), 52));
+                    __m512d s2 = _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(b2, bias), 52));
+                    return _mm512_mul_pd(_mm512_mul_pd(p, s1), s2);
+                }
+
+                inline __m512 exp_ps(__m512 x) {
+                    x = _mm512_min_ps(_mm512_set1_ps(max_input_f), x);
+                    x = _mm512_max_ps(_mm512_set1_ps(min_input_f), x);
+
+                    const __m512 shift = _mm512_set1_ps(shifter_f);
+                    __m512 k = _mm512_sub_ps(_mm512_fmadd_ps(x, _mm512_set1_ps(log2e_f), shift), shift);
+                    __m512 r = _mm512_fnmadd_ps(k, _mm512_set1_ps(ln2_hi_f), x);
+                    r = _mm512_fnmadd_ps(k, _mm512_set1_ps(ln2_lo_f), r);
+
+                    __m512 p = _mm512_set1_ps(poly_f[poly_degree_f]);
+                    for (int i = poly_degree_f - 1; i >= 0; --i) {
+                        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(poly_f[i]));
+                    }
+
+                    __m512 k1 = _mm512_sub_ps(_mm512_fmadd_ps(k, _mm512_set1_ps(0.5f), shift), shift);
+                    __m512i b1 = _mm512_castps_si512(_mm512_add_ps(k1, shift));
+                    __m512i b2 = _mm512_castps_si512(_mm512_add_ps(_mm512_sub_ps(k, k1), shift));
+                    const __m512i bias = _mm512_set1_epi32(127);
+                    __m512 s1 = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(b1, bias), 23));
+                    __m512 s2 = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(b2, bias), 23));
+                    return _mm512_mul_ps(_mm512_mul_ps(p, s1), s2);
+                }
+            }
+
+            void exp_avx512(const double *in, double *out, std::size_t n) {
+                std::size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    _mm512_storeu_pd(out + i, exp_pd(_mm512_loadu_pd(in + i)));
+                }
+                if (i < n) {
+                    __mmask8 mask = static_cast<__mmask8>((1u << (n - i)) - 1);
+                    _mm512_mask_storeu_pd(out + i, mask, exp_pd(_mm512_maskz_loadu_pd(mask, in + i)));
+                }
+            }
+
+            void exp_avx512(const float *in, float *out, std::size_t n) {
+                std::size_t i = 0;
+                for (; i + 16 <= n; i += 16) {
+                    _mm512_storeu_ps(out + i, exp_ps(_mm512_loadu_ps(in + i)));
+                }
+                if (i < n) {
+                    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+                    _mm512_mask_storeu_ps(out + i, mask, exp_ps(_mm512_maskz_loadu_ps(mask, in + i)));
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,143 @@
+# ifndef exp_kernels_h
+# define exp_kernels_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// batch exp kernels, one translation unit per instruction set
+// each translation unit is compiled with the flags of its own set and picked at runtime (see dispatch.cxx)
+// all kernels share the same algorithm so that they agree up to rounding:
+//   x = k * ln2 + r with |r| <= ln2 / 2
+//   exp(x) = 2^k * exp(r), exp(r) is a degree 13 (double) or 7 (float) polynomial
+//   2^k is applied in two halves so that subnormal results are rounded only once
+// out of range inputs are clamped, which makes +inf overflow and -inf underflow naturally
+// NaN survives the clamp and propagates through the polynomial
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Kernels {
+            // double precision constants
+            constexpr double log2e = 1.4426950408889634074;
+            constexpr double ln2_hi = 6.93147180369123816490e-01; // trailing zeros keep k * ln2_hi exact
+            constexpr double ln2_lo = 1.90821492927058770002e-10;
+            constexpr double shifter = 6755399441055744.0; // 1.5 * 2^52, rounds to integer when added
+            constexpr double max_input = 710.0;  // exp overflows above ~709.78
+            constexpr double min_input = -746.0; // exp underflows to 0 below ~-745.13
+            constexpr int poly_degree = 13;
+            constexpr double poly[poly_degree + 1] = { // 1 / n!
+                1.0,
+                1.0,
+                1.0 / 2,
+                1.0 / 6,
+                1.0 / 24,
+                1.0 / 120,
+                1.0 / 720,
+                1.0 / 5040,
+                1.0 / 40320,
+                1.0 / 362880,
+                1.0 / 3628800,
+                1.0 / 39916800,
+                1.0 / 479001600,
+                1.0 / 6227020800,
+            };
+
+            // single precision constants
+            constexpr float log2e_f = 1.44269504f;
+            constexpr float ln2_hi_f = 0.693359375f;
+            constexpr float ln2_lo_f = -2.12194440e-4f;
+            constexpr float shifter_f = 12582912.0f; // 1.5 * 2^23
+            constexpr float max_input_f = 89.0f;
+            constexpr float min_input_f = -104.0f;
+            constexpr int poly_degree_f = 7;
+            constexpr float poly_f[poly_degree_f + 1] = {
+                1.0f,
+                1.0f,
+                1.0f / 2,
+                1.0f / 6,
+                1.0f / 24,
+                1.0f / 120,
+                1.0f / 720,
+                1.0f / 5040,
+            };
+
+            // reference implementation of the shared algorithm, also used for loop tails
+            // static: every kernel source is compiled with different instruction set flags,
+            //   a shared inline copy could hand AVX code to the scalar path on older machines
+            static inline double exp_scalar(double x) {
+                // comparisons against NaN are false, so NaN passes through
+                x = x > max_input ? max_input : x;
+                x = x < min_input ? min_input : x;
+
+                double k = (x * log2e + shifter) - shifter;
+                double r = (x - k * ln2_hi) - k * ln2_lo;
+
+                double p = poly[poly_degree];
+                for (int i = poly_degree - 1; i >= 0; --i) {
+                    p = p * r + poly[i];
+                }
+
+                // k1 + shifter holds k1 in its low mantissa bits, which become the exponent field
+                double k1 = (k * 0.5 + shifter) - shifter;
+                double t1 = k1 + shifter;
+                double t2 = (k - k1) + shifter;
+                std::uint64_t b1, b2;
+                std::memcpy(&b1, &t1, sizeof(double));
+                std::memcpy(&b2, &t2, sizeof(double));
+                b1 = (b1 + 1023) << 52;
+                b2 = (b2 + 1023) << 52;
+                double s1, s2;
+                std::memcpy(&s1, &b1, sizeof(double));
+                std::memcpy(&s2, &b2, sizeof(double));
+                return p * s1 * s2;
+            }
+
+            static inline float exp_scalar(float x) {
+                x = x > max_input_f ? max_input_f : x;
+                x = x < min_input_f ? min_input_f : x;
+
+                float k = (x * log2e_f + shifter_f) - shifter_f;
+                float r = (x - k * ln2_hi_f) - k * ln2_lo_f;
+
+                float p = poly_f[poly_degree_f];
+                for (int i = poly_degree_f - 1; i >= 0; --i) {
+                    p = p * r + poly_f[i];
+                }
+
+                float k1 = (k * 0.5f + shifter_f) - shifter_f;
+                float t1 = k1 + shifter_f;
+                float t2 = (k - k1) + shifter_f;
+                std::uint32_t b1, b2;
+                std::memcpy(&b1, &t1, sizeof(float));
+                std::memcpy(&b2, &t2, sizeof(float));
+                b1 = (b1 + 127) << 23;
+                b2 = (b2 + 127) << 23;
+                float s1, s2;
+                std::memcpy(&s1, &b1, sizeof(float));
+                std::memcpy(&s2, &b2, sizeof(float));
+                return p * s1 * s2;
+            }
+
+            void exp_scalar(const double *in, double *out, std::size_t n);
+            void exp_scalar(const float *in, float *out, std::size_t n);
+            void exp_sse2(const double *in, double *out, std::size_t n);
+            void exp_sse2(const float *in, float *out, std::size_t n);
+            void exp_avx2(const double *in, double *out, std::size_t n);
+            void exp_avx2(const float *in, float *out, std::size_t n);
+            void exp_avx512(const double *in, double *out, std::size_t n);
+            void exp_avx512(const float *in, float *out, std::size_t n);
+
+            // one entry per instruction set tier, see dispatch.cxx
+            struct Dispatch {
+                const char *name;
+                void (*exp_double)(const double *, double *, std::size_t);
+                void (*exp_float)(const float *, float *, std::size_t);
+            };
+
+            // resolved once on first use from the CPU features and the CUSTOMMATH_ISA environment variable
+            const Dispatch &dispatch();
+        }
+    }
+}
+
+# endif
@@ -0,0 +1,271 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "Generated.h"
+#include "arithmetics.h"
+#include "exp_kernels.h"
+
+// correctly rounded exp, Ziv's strategy in two steps:
+//   1. the table-driven algorithm of arithmetics.cxx carried out in double-double, relative error below 2^-100
+//      if both ends of the error interval round to the same double, that double is the answer
+//   2. otherwise (about one input in 2^40, plus subnormal results) exp is recomputed in 192-bit fixed point,
+//      far beyond the ~2^-113 the hardest known double inputs of exp need
+// double-double values are unevaluated sums hi + lo with |lo| <= ulp(hi) / 2
+
+namespace CustomMath {
+    namespace Inner {
+        namespace {
+            struct DoubleDouble {
+                double hi, lo;
+            };
+
+            DoubleDouble fast_two_sum(double a, double b) {
+                double s = a + b;
+                return {s, b - (s - a)};
+            }
+
+            DoubleDouble two_sum(double a, double b) {
+                double s = a + b;
+                double bb = s - a;
+                return {s, (a - (s - bb)) + (b - bb)};
+            }
+
+            // Dekker's product, without fma so that the library stays at the baseline instruction set
+            void split(double a, double &hi, double &lo) {
+                double c = 134217729.0 * a; // 2^27 + 1
+                hi = c - (c - a);
+                lo = a - hi;
+            }
+
+            DoubleDouble two_prod(double a, double b) {
+                double p = a * b;
+                double ah, al, bh, bl;
+                split(a, ah, al);
+                split(b, bh, bl);
+                return {p, ((ah * bh - p) + ah * bl + al * bh) + al * bl};
+            }
+
+            DoubleDouble add(DoubleDouble a, DoubleDouble b) {
+                DoubleDouble s = two_sum(a.hi, b.hi);
+                DoubleDouble t = two_sum(a.lo, b.lo);
+                s = fast_two_sum(s.hi, s.lo + t.hi);
+                return fast_two_sum(s.hi, s.lo + t.lo);
+            }
+
+            DoubleDouble mul(DoubleDouble a, DoubleDouble b) {
+                DoubleDouble p = two_prod(a.hi, b.hi);
+                return fast_two_sum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+            }
+
+            // ln2 = ln2_hi + ln2_lo + ln2_lo2 to ~2^-140, the first two are the fdlibm pair of exp_kernels.h
+            constexpr double ln2_lo2 = 0x1.cc01f97b57a08p-87;
+
+            // the step 1 result is trusted to this relative error, twice the worst case analysis for margin
+            constexpr double fast_path_error = 0x1p-99;
+
+            // results below this input can be subnormal, they go straight to step 2
+            constexpr double min_normal_input = -708.0;
+
+            // step 1, returns false when the rounding cannot be decided
+            bool exp_double_double(double a, double &result) {
+                using namespace Generated;
+                const double n = exp_table_size;
+
+                // a = k * ln2 / N + r, k * ln2_hi / N is exact and so is a - k * ln2_hi / N
+                double kd = (a * exp_inv_step + Kernels::shifter) - Kernels::shifter;
+                double t = a - kd * exp_step_hi;
+                DoubleDouble p = two_prod(kd, Kernels::ln2_lo / n);
+                DoubleDouble r = two_sum(t, -p.hi);
+                r = fast_two_sum(r.hi, r.lo - (p.lo + kd * (ln2_lo2 / n)));
+
+                std::int64_t k = static_cast<std::int64_t>(kd);
+                std::int64_t j = k & (exp_table_size - 1);
+                std::int64_t e = (k - j) / exp_table_size;
+
+                // exp(r) by Horner, the terms from exp_precise_head on are small enough for plain double
+                // only the head of the series needs double-double
+                double tail = exp_inv_factorial_hi[exp_precise_degree];
+                for (int i = exp_precise_degree - 1; i >= exp_precise_head; --i)
+                    tail = tail * r.hi + exp_inv_factorial_hi[i];
+                DoubleDouble q = {tail, 0};
+                for (int i = exp_precise_head - 1; i >= 0; --i)
+                    q = add(mul(q, r), {exp_inv_factorial_hi[i], exp_inv_factorial_lo[i]});
+                DoubleDouble v = mul({exp_table_hi[j], exp_table_lo[j]}, q);
+
+                // Ziv's rounding test, v is positive
+                double up = v.hi + (v.lo + v.hi * fast_path_error);
+                double down = v.hi + (v.lo - v.hi * fast_path_error);
+                if (up != down)
+                    return false;
+
+                // the result is normal, so both halves of 2^e scale it exactly
+                std::int64_t e1 = e / 2;
+                std::uint64_t b1 = static_cast<std::uint64_t>(e1 + 1023) << 52;
+                std::uint64_t b2 = static_cast<std::uint64_t>(e - e1 + 1023) << 52;
+                double s1, s2;
+                std::memcpy(&s1, &b1, sizeof(double));
+                std::memcpy(&s2, &b2, sizeof(double));
+                result = up * s1 * s2;
+                return true;
+            }
+
+            // unsigned fixed point, value = sum of limb[i] * 2^(32 * i - 192), limb 6 is the integer part
+            constexpr int limbs = 7;
+            constexpr int fraction_bits = 192;
+            using Fixed = std::array<std::uint32_t, limbs>;
+
+            // fractional part of ln2, rounded down to 192 bits
+            constexpr Fixed ln2_fixed = {0x7298b62d, 0x40f34326, 0x03f2f6af, 0xc9e3b398, 0xd1cf79ab, 0xb17217f7, 0};
+
+            bool less(const Fixed &a, const Fixed &b) {
+                for (int i = limbs - 1; i >= 0; --i)
+                    if (a[i] != b[i])
+                        return a[i] < b[i];
+                return false;
+            }
+
+            Fixed plus(const Fixed &a, const Fixed &b) {
+                Fixed s{};
+                std::uint64_t carry = 0;
+                for (int i = 0; i < limbs; ++i) {
+                    carry += std::uint64_t(a[i]) + b[i];
+                    s[i] = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+                return s;
+            }
+
+            // a - b for a >= b
+            Fixed minus(const Fixed &a, const Fixed &b) {
+                Fixed d{};
+                std::int64_t borrow = 0;
+                for (int i = 0; i < limbs; ++i) {
+                    std::int64_t v = std::int64_t(a[i]) - b[i] - borrow;
+                    borrow = v < 0;
+                    d[i] = static_cast<std::uint32_t>(v + (borrow << 32));
+                }
+                return d;
+            }
+
+            Fixed times(const Fixed &a, std::uint32_t b) {
+                Fixed p{};
+                std::uint64_t carry = 0;
+                for (int i = 0; i < limbs; ++i) {
+                    carry += std::uint64_t(a[i]) * b;
+                    p[i] = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+                return p;
+            }
+
+            // truncated product, both operands are below 2
+            Fixed times(const Fixed &a, const Fixed &b) {
+                std::uint64_t wide[2 * limbs + 1] = {};
+                for (int i = 0; i < limbs; ++i) {
+                    std::uint64_t carry = 0;
+                    for (int k = 0; k < limbs; ++k) {
+                        carry += wide[i + k] + std::uint64_t(a[i]) * b[k];
+                        wide[i + k] = static_cast<std::uint32_t>(carry);
+                        carry >>= 32;
+                    }
+                    wide[i + limbs] = carry;
+                }
+                Fixed p{};
+                for (int i = 0; i < limbs; ++i)
+                    p[i] = static_cast<std::uint32_t>(wide[i + fraction_bits / 32]);
+                return p;
+            }
+
+            Fixed divided(const Fixed &a, std::uint32_t b) {
+                Fixed q{};
+                std::uint64_t rest = 0;
+                for (int i = limbs - 1; i >= 0; --i) {
+                    rest = (rest << 32) | a[i];
+                    q[i] = static_cast<std::uint32_t>(rest / b);
+                    rest %= b;
+                }
+                return q;
+            }
+
+            bool bit(const Fixed &a, int i) { return (a[i / 32] >> (i % 32)) & 1; }
+
+            // |a| as fixed point, exact for 2^-54 <= |a| < 2^32
+            Fixed to_fixed(double a) {
+                int exponent;
+                double m = std::frexp(std::fabs(a), &exponent);
+                std::uint64_t mantissa = static_cast<std::uint64_t>(std::ldexp(m, 53));
+                int shift = exponent - 53 + fraction_bits; // position of the lowest mantissa bit
+                Fixed f{};
+                for (int i = 0; i < 53; ++i)
+                    if ((mantissa >> i) & 1)
+                        f[(shift + i) / 32] |= std::uint32_t(1) << ((shift + i) % 32);
+                return f;
+            }
+
+            // v * 2^k rounded to nearest even, v in [0.5, 2), subnormal results keep fewer bits
+            double round_scaled(const Fixed &v, std::int64_t k) {
+                int top = bit(v, fraction_bits) ? fraction_bits : fraction_bits - 1;
+                std::int64_t e = k + top - fraction_bits;
+                std::int64_t precision = e < -1022 ? 53 - (-1022 - e) : 53;
+                if (precision < 0)
+                    return 0;
+                std::uint64_t mantissa = 0;
+                for (int i = 0; i < precision; ++i)
+                    mantissa = (mantissa << 1) | bit(v, top - i);
+                int half = top - static_cast<int>(precision);
+                bool sticky = false;
+                for (int i = 0; i < half && !sticky; ++i)
+                    sticky = bit(v, i);
+                if (bit(v, half) && (sticky || (mantissa & 1)))
+                    ++mantissa;
+                return std::ldexp(static_cast<double>(mantissa), static_cast<int>(e - precision + 1));
+            }
+
+            // step 2: a = k * ln2 + r with |r| <= ln2 / 2, exp(r) summed as a Taylor series
+            double exp_fixed_point(double a) {
+                double kd = std::nearbyint(a / 0.6931471805599453);
+                std::int64_t k = static_cast<std::int64_t>(kd);
+                Fixed x = to_fixed(a);
+                Fixed kln2 = times(ln2_fixed, static_cast<std::uint32_t>(k < 0 ? -k : k));
+                // both a and k * ln2 have the sign of a, so r has it when |a| >= |k| ln2
+                bool negative = less(x, kln2) != (a < 0);
+                Fixed r = less(x, kln2) ? minus(kln2, x) : minus(x, kln2);
+
+                Fixed one{};
+                one[limbs - 1] = 1;
+                Fixed sum = one, term = one;
+                // |r| < 0.35 keeps every partial sum of the alternating series positive
+                for (std::uint32_t n = 1; n < 64; ++n) {
+                    term = divided(times(term, r), n);
+                    if (term == Fixed{})
+                        break;
+                    sum = (negative && (n & 1)) ? minus(sum, term) : plus(sum, term);
+                }
+
+                // truncation and the 192-bit ln2 leave an error far below 2^-176, round both ends of it
+                Fixed error{};
+                error[(fraction_bits - 176) / 32] = std::uint32_t(1) << ((fraction_bits - 176) % 32);
+                double low = round_scaled(minus(sum, error), k);
+                double high = round_scaled(plus(sum, error), k);
+                return low == high ? low : round_scaled(sum, k);
+            }
+        }
+
+        double exp_correctly_rounded(double a) {
+            // NaN fails both comparisons and is returned as is
+            if (!(a <= 0x1.62e42fefa39efp+9)) // largest input whose exp rounds to a finite double
+                return a > 0 ? HUGE_VAL : a;
+            if (a < -0x1.74910d52d3051p+9) // below this exp(a) is under half the smallest subnormal
+                return 0;
+            // |exp(a) - 1| is under half an ulp of 1
+            if (std::fabs(a) < 0x1p-54)
+                return 1;
+
+            double result;
+            if (a >= min_normal_input && exp_double_double(a, result))
+                return result;
+            return exp_fixed_point(a);
+        }
+    }
+}
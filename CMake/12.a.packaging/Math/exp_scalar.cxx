@@ -0,0 +1,19 @@
+#include "exp_kernels.h"
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Kernels {
+            void exp_scalar(const double *in, double *out, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = exp_scalar(in[i]);
+                }
+            }
+
+            void exp_scalar(const float *in, float *out, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = exp_scalar(in[i]);
+                }
+            }
+        }
+    }
+}
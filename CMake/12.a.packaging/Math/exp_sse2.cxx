@@ -0,0 +1,82 @@
+#include "exp_kernels.h"
+
+// SSE2 is part of the x86-64 baseline, 2 doubles or 4 floats per register
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Kernels {
+            namespace {
+                inline __m128d exp_pd(__m128d x) {
+                    // min/max return the second operand for NaN, so NaN is kept
+                    x = _mm_min_pd(_mm_set1_pd(max_input), x);
+                    x = _mm_max_pd(_mm_set1_pd(min_input), x);
+
+                    const __m128d shift = _mm_set1_pd(shifter);
+                    __m128d k = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(log2e)), shift), shift);
+                    __m128d r = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(ln2_hi)));
+                    r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(ln2_lo)));
+
+                    __m128d p = _mm_set1_pd(poly[poly_degree]);
+                    for (int i = poly_degree - 1; i >= 0; --i) {
+                        p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(poly[i]));
+                    }
+
+                    __m128d k1 = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(k, _mm_set1_pd(0.5)), shift), shift);
+                    __m128i b1 = _mm_castpd_si128(_mm_add_pd(k1, shift));
+                    __m128i b2 = _mm_castpd_si128(_mm_add_pd(_mm_sub_pd(k, k1), shift));
+                    const __m128i bias = _mm_set1_epi64x(1023);
+                    __m128d s1 = _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(b1, bias), 52));
+                    __m128d s2 = _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(b2, bias), 52));
+                    return _mm_mul_pd(_mm_mul_pd(p, s1), s2);
+                }
+
+                inline __m128 exp_ps(__m128 x) {
+                    x = _mm_min_ps(_mm_set1_ps(max_input_f), x);
+                    x = _mm_max_ps(_mm_set1_ps(min_input_f), x);
+
+                    const __m128 shift = _mm_set1_ps(shifter_f);
+                    __m128 k = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(log2e_f)), shift), shift);
+                    __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(ln2_hi_f)));
+                    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(ln2_lo_f)));
+
+                    __m128 p = _mm_set1_ps(poly_f[poly_degree_f]);
+                    for (int i = poly_degree_f - 1; i >= 0; --i) {
+                        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(poly_f[i]));
+                    }
+
+                    __m128 k1 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(k, _mm_set1_ps(0.5f)), shift), shift);
+                    __m128i b1 = _mm_castps_si128(_mm_add_ps(k1, shift));
+                    __m128i b2 = _mm_castps_si128(_mm_add_ps(_mm_sub_ps(k, k1), shift));
+                    const __m128i bias = _mm_set1_epi32(127);
+                    __m128 s1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(b1, bias), 23));
+                    __m128 s2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(b2, bias), 23));
+                    return _mm_mul_ps(_mm_mul_ps(p, s1), s2);
+                }
+            }
+
+            void exp_sse2(const double *in, double *out, std::size_t n) {
+                std::size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    _mm_storeu_pd(out + i, exp_pd(_mm_loadu_pd(in + i)));
+                }
+                for (; i < n; ++i) {
+                    out[i] = exp_scalar(in[i]);
+                }
+            }
+
+            void exp_sse2(const float *in, float *out, std::size_t n) {
+                std::size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    _mm_storeu_ps(out + i, exp_ps(_mm_loadu_ps(in + i)));
+                }
+                for (; i < n; ++i) {
+                    out[i] = exp_scalar(in[i]);
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "parallel.h"
+#include <atomic>
+#include "arithmetics.h"
+#include "Tuning.h"
+
+#ifdef MATH_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+// large batch calls are split across OpenMP threads, one contiguous chunk per thread
+// forking and joining a parallel region costs microseconds, so a thread is only added for every grain_bytes of input
+// smaller calls, calls from inside a parallel region and builds without OpenMP run on the calling thread
+
+namespace CustomMath {
+    namespace Inner {
+        namespace {
+            // an L2 of input per thread, at least 256 KiB: tens of microseconds of kernel time even at several GB/s,
+            // far above the fork/join cost
+            constexpr std::size_t grain_bytes = Tuning::l2 > (std::size_t(1) << 18) ? Tuning::l2 : std::size_t(1) << 18;
+
+            // chunk lengths are multiples of 64 bytes, the widest vector of exp_kernels.h
+            // so every element takes the same path (vector body or scalar tail) as in one single-threaded call,
+            // and of the cache line, so that for aligned arrays no two threads write the same line
+            constexpr std::size_t line_bytes = Tuning::cache_line > 64 ? Tuning::cache_line : 64;
+
+            // 0 means the OpenMP default, which follows OMP_NUM_THREADS
+            std::atomic<int> thread_limit{0};
+
+            template <typename T>
+            std::size_t boundary(std::size_t n, std::size_t threads, std::size_t t) {
+                const std::size_t line = line_bytes / sizeof(T);
+                std::size_t i = (n / threads * t + line - 1) / line * line;
+                return t == threads || i > n ? n : i;
+            }
+
+            template <typename T>
+            void split(void (*kernel)(const T *, T *, std::size_t), const T *in, T *out, std::size_t n) {
+#ifdef MATH_HAVE_OPENMP
+                // small calls, e.g. the blocks of Array.h, leave before asking OpenMP anything
+                std::size_t threads = n / (grain_bytes / sizeof(T));
+                if (threads > 1) {
+                    std::size_t limit = static_cast<std::size_t>(num_threads());
+                    threads = threads < limit ? threads : limit;
+                }
+                if (threads > 1 && !omp_in_parallel()) {
+                    // int for the loop variable, MSVC only supports OpenMP 2.0
+                    const int count = static_cast<int>(threads);
+#pragma omp parallel for num_threads(count) schedule(static, 1)
+                    for (int t = 0; t < count; ++t) {
+                        std::size_t begin = boundary<T>(n, threads, t);
+                        std::size_t end = boundary<T>(n, threads, t + 1);
+                        if (begin < end)
+                            kernel(in + begin, out + begin, end - begin);
+                    }
+                    return;
+                }
+#endif
+                kernel(in, out, n);
+            }
+        }
+
+        namespace Parallel {
+            void run(void (*kernel)(const double *, double *, std::size_t), const double *in, double *out, std::size_t n) {
+                split(kernel, in, out, n);
+            }
+
+            void run(void (*kernel)(const float *, float *, std::size_t), const float *in, float *out, std::size_t n) {
+                split(kernel, in, out, n);
+            }
+        }
+
+        void set_num_threads(int n) { thread_limit = n > 0 ? n : 0; }
+
+        int num_threads() {
+#ifdef MATH_HAVE_OPENMP
+            int limit = thread_limit;
+            return limit > 0 ? limit : omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+    }
+}
@@ -0,0 +1,18 @@
+# ifndef parallel_h
+# define parallel_h
+
+#include <cstddef>
+
+// splits large batch calls across threads, see parallel.cxx
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Parallel {
+            // kernel(in + begin, out + begin, end - begin) on every chunk, possibly on several threads at once
+            void run(void (*kernel)(const double *, double *, std::size_t), const double *in, double *out, std::size_t n);
+            void run(void (*kernel)(const float *, float *, std::size_t), const float *in, float *out, std::size_t n);
+        }
+    }
+}
+
+# endif
@@ -0,0 +1,134 @@
+#include "Math.h"
+#include <cmath>
+#include <limits>
+#include "arithmetics.h"
+
+// sum, dot and mean with the strategies of CustomMath::Summation
+// every strategy accumulates in the precision of the input, so float shows the differences most
+// a dot product is a sum over the terms a[i] * b[i], the strategies are shared through a term loader:
+//   Load::term(i) returns the rounded term, Load::error(i) what the rounding lost (only Compensated asks for it)
+// the library stays at the baseline instruction set, Simd relies on the compiler keeping the independent
+// accumulators in vector registers, which it does at -O2 for SSE2 without any fast-math flag
+
+namespace CustomMath {
+    namespace Inner {
+        namespace {
+            // independent accumulators of Simd, 8 SSE2 registers of doubles or 4 of floats
+            constexpr std::size_t accumulators = 16;
+
+            // Pairwise sums blocks of this size with 8 accumulators, and combines the blocks pairwise
+            constexpr std::size_t pairwise_block = 128;
+
+            template <typename T>
+            struct Values {
+                const T *in;
+                T term(std::size_t i) const { return in[i]; }
+                T error(std::size_t) const { return 0; }
+            };
+
+            template <typename T>
+            struct Products {
+                const T *a, *b;
+                T term(std::size_t i) const { return a[i] * b[i]; }
+
+                // Dekker's two-product without fma, a * b = term + error exactly
+                T error(std::size_t i) const {
+                    constexpr T splitter = T((1 << (std::numeric_limits<T>::digits - std::numeric_limits<T>::digits / 2)) + 1);
+                    T x = a[i], y = b[i], p = x * y;
+                    T cx = splitter * x, cy = splitter * y;
+                    T xh = cx - (cx - x), yh = cy - (cy - y);
+                    T xl = x - xh, yl = y - yh;
+                    return ((xh * yh - p) + xh * yl + xl * yh) + xl * yl;
+                }
+            };
+
+            template <typename T, typename Load>
+            T naive(const Load &load, std::size_t begin, std::size_t end) {
+                T s = 0;
+                for (std::size_t i = begin; i < end; ++i)
+                    s += load.term(i);
+                return s;
+            }
+
+            template <typename T, typename Load>
+            T simd(const Load &load, std::size_t n) {
+                T acc[accumulators] = {};
+                std::size_t i = 0;
+                for (; i + accumulators <= n; i += accumulators)
+                    for (std::size_t j = 0; j < accumulators; ++j)
+                        acc[j] += load.term(i + j);
+                for (std::size_t width = accumulators / 2; width > 0; width /= 2)
+                    for (std::size_t j = 0; j < width; ++j)
+                        acc[j] += acc[j + width];
+                return acc[0] + naive<T>(load, i, n);
+            }
+
+            template <typename T, typename Load>
+            T pairwise(const Load &load, std::size_t begin, std::size_t end) {
+                std::size_t n = end - begin;
+                if (n <= pairwise_block) {
+                    if (n < 8)
+                        return naive<T>(load, begin, end);
+                    T acc[8] = {};
+                    const std::size_t blocks = n / 8;
+                    for (std::size_t k = 0; k < blocks; ++k)
+                        for (std::size_t j = 0; j < 8; ++j)
+                            acc[j] += load.term(begin + 8 * k + j);
+                    T s = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+                    return s + naive<T>(load, begin + 8 * blocks, end);
+                }
+                // split on a multiple of 8 so that the blocks keep their unrolled loop
+                std::size_t half = n / 2 / 8 * 8;
+                return pairwise<T>(load, begin, begin + half) + pairwise<T>(load, begin + half, end);
+            }
+
+            // Neumaier: the compensation collects the low part of every addition, whichever operand is larger
+            // once the sum overflows or meets an infinite term the low parts are inf - inf, the sum alone is the result
+            template <typename T, typename Load>
+            T compensated(const Load &load, std::size_t n, bool exact_terms) {
+                T s = 0, c = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    T x = load.term(i);
+                    T t = s + x;
+                    if (std::isfinite(t)) {
+                        c += std::fabs(s) >= std::fabs(x) ? (s - t) + x : (x - t) + s;
+                        if (!exact_terms)
+                            c += load.error(i);
+                    }
+                    s = t;
+                }
+                return std::isfinite(s) ? s + c : s;
+            }
+
+            template <typename T, typename Load>
+            T reduce(const Load &load, std::size_t n, Summation strategy, bool exact_terms) {
+                switch (strategy) {
+                case Summation::Naive: return naive<T>(load, 0, n);
+                case Summation::Simd: return simd<T>(load, n);
+                case Summation::Compensated: return compensated<T>(load, n, exact_terms);
+                case Summation::Pairwise:
+                default: return pairwise<T>(load, 0, n);
+                }
+            }
+        }
+
+        double sum(const double *in, std::size_t n, Summation s) { return reduce<double>(Values<double>{in}, n, s, true); }
+        float sum(const float *in, std::size_t n, Summation s) { return reduce<float>(Values<float>{in}, n, s, true); }
+
+        double dot(const double *a, const double *b, std::size_t n, Summation s) {
+            return reduce<double>(Products<double>{a, b}, n, s, false);
+        }
+
+        float dot(const float *a, const float *b, std::size_t n, Summation s) {
+            return reduce<float>(Products<float>{a, b}, n, s, false);
+        }
+
+        double mean(const double *in, std::size_t n, Summation s) {
+            return n ? Inner::sum(in, n, s) / double(n) : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        float mean(const float *in, std::size_t n, Summation s) {
+            return n ? Inner::sum(in, n, s) / float(n) : std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+}
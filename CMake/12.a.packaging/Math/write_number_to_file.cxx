@@ -1,8 +1,212 @@
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+// usage: WriteNumberToFile <constant> <output header> [exp table bits]
+//
+// besides the constant, the header holds the tables of the table-driven exp (see arithmetics.cxx):
+//   exp(x) = 2^e * 2^(j/N) * exp(r), where x = (e * N + j) * ln2 / N + r and |r| <= ln2 / 2N
+// N = 2^bits entries of 2^(j/N) are stored as a hi + lo pair, computed in double-double so each entry is exact to ~2^-104
+// exp(r) - 1 is approximated by r + r^2 * q(r), q interpolated at Chebyshev nodes (close to minimax)
+// larger tables shrink r, so fewer polynomial terms are needed at the cost of cache footprint
+// one polynomial is emitted per accuracy tier of Math.h (Accurate, Fast and Float), all share the table
+// the CorrectlyRounded tier evaluates the Taylor series of exp(r), the leading terms in double-double, 1 / n! is emitted as hi + lo
+
+namespace {
+    // fdlibm split of ln2, the trailing zeros of the high part keep k * ln2_hi / N exact
+    const long double ln2_hi = 6.93147180369123816490e-01L;
+    const long double ln2_lo = 1.90821492927058770002e-10L;
+    const long double ln2 = 0.693147180559945309417232121458176568L;
+    const long double pi = 3.14159265358979323846264338327950288L;
+
+    // double-double arithmetic for the table entries, long double alone only carries 64 bits
+    struct DoubleDouble {
+        double hi, lo;
+    };
+    const DoubleDouble ln2_dd = {0x1.62e42fefa39efp-1, 0x1.abc9e3b39803fp-56};
+
+    DoubleDouble fast_two_sum(double a, double b) {
+        double s = a + b;
+        return {s, b - (s - a)};
+    }
+
+    DoubleDouble two_sum(double a, double b) {
+        double s = a + b;
+        double bb = s - a;
+        return {s, (a - (s - bb)) + (b - bb)};
+    }
+
+    DoubleDouble dd_add(DoubleDouble a, DoubleDouble b) {
+        DoubleDouble s = two_sum(a.hi, b.hi);
+        DoubleDouble t = two_sum(a.lo, b.lo);
+        s = fast_two_sum(s.hi, s.lo + t.hi);
+        return fast_two_sum(s.hi, s.lo + t.lo);
+    }
+
+    DoubleDouble dd_mul(DoubleDouble a, DoubleDouble b) {
+        double p = a.hi * b.hi;
+        double e = std::fma(a.hi, b.hi, -p);
+        return fast_two_sum(p, e + (a.hi * b.lo + a.lo * b.hi));
+    }
+
+    DoubleDouble dd_div(DoubleDouble a, double b) {
+        double q1 = a.hi / b;
+        double p = q1 * b;
+        double e = std::fma(q1, b, -p);
+        double q2 = (((a.hi - p) - e) + a.lo) / b;
+        return fast_two_sum(q1, q2);
+    }
+
+    // 2^(j/N) = exp(j/N * ln2) as a Taylor series, the argument stays below ln2
+    DoubleDouble exp2_dd(int j, int size) {
+        DoubleDouble y = dd_mul(ln2_dd, {static_cast<double>(j) / size, 0});
+        DoubleDouble sum = {1, 0}, term = {1, 0};
+        for (int n = 1; n < 40; ++n) {
+            term = dd_div(dd_mul(term, y), n);
+            sum = dd_add(sum, term);
+        }
+        return sum;
+    }
+
+    // solves the (small) linear system a * x = b with partial pivoting
+    std::vector<long double> solve(std::vector<std::vector<long double>> a, std::vector<long double> b) {
+        const std::size_t n = b.size();
+        for (std::size_t col = 0; col < n; ++col) {
+            std::size_t pivot = col;
+            for (std::size_t row = col + 1; row < n; ++row)
+                if (std::fabs(a[row][col]) > std::fabs(a[pivot][col]))
+                    pivot = row;
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for (std::size_t row = col + 1; row < n; ++row) {
+                long double f = a[row][col] / a[col][col];
+                for (std::size_t k = col; k < n; ++k)
+                    a[row][k] -= f * a[col][k];
+                b[row] -= f * b[col];
+            }
+        }
+        std::vector<long double> x(n);
+        for (std::size_t i = n; i-- > 0;) {
+            long double s = b[i];
+            for (std::size_t k = i + 1; k < n; ++k)
+                s -= a[i][k] * x[k];
+            x[i] = s / a[i][i];
+        }
+        return x;
+    }
+
+    // (exp(r) - 1 - r) / r^2 as a series, expm1 would cancel badly near r = 0
+    long double exp_tail(long double r) {
+        long double sum = 0, term = 0.5L;
+        for (int n = 2; n < 40; ++n) {
+            sum += term;
+            term *= r / (n + 1);
+        }
+        return sum;
+    }
+
+    // coefficients of r^0..r^degree for exp(r) on [-h, h], the first two are fixed to 1
+    std::vector<long double> exp_polynomial(long double h, int degree) {
+        // q(r) = (exp(r) - 1 - r) / r^2 is fitted in u = r / h on [-1, 1] to keep the system well conditioned
+        const int m = degree - 2;
+        std::vector<std::vector<long double>> a(m + 1, std::vector<long double>(m + 1));
+        std::vector<long double> b(m + 1);
+        for (int i = 0; i <= m; ++i) {
+            long double u = std::cos(pi * (2 * i + 1) / (2 * (m + 1)));
+            long double r = u * h;
+            b[i] = exp_tail(r);
+            for (int k = 0; k <= m; ++k)
+                a[i][k] = std::pow(u, k);
+        }
+        std::vector<long double> q = solve(a, b);
+
+        std::vector<long double> coefficients = {1.0L, 1.0L};
+        for (int k = 0; k <= m; ++k)
+            coefficients.push_back(q[k] / std::pow(h, k));
+        return coefficients;
+    }
+
+    // smallest degree whose Taylor truncation error on [-h, h] is below 2^-bits
+    int degree_for(long double h, int bits) {
+        int degree = 2;
+        long double term = h * h / 2;
+        while (term * h / (degree + 1) > std::ldexp(1.0L, -bits)) {
+            ++degree;
+            term *= h / degree;
+        }
+        return degree;
+    }
+
+    std::vector<double> to_double(const std::vector<long double> &values) {
+        return std::vector<double>(values.begin(), values.end());
+    }
+
+    void write_array(std::ofstream &write, const char *name, const std::vector<double> &values) {
+        write << "    constexpr double " << name << "[" << values.size() << "] = {\n";
+        for (double v : values)
+            write << "        " << v << ",\n";
+        write << "    };\n";
+    }
+}
 
 int main(int argc, char *argv[]) {
+    int bits = argc > 3 ? std::stoi(argv[3]) : 7;
+    // beyond 10 bits, k * ln2_hi / N is no longer exact in double precision
+    bits = bits < 1 ? 1 : (bits > 10 ? 10 : bits);
+    const int size = 1 << bits;
+    const long double h = ln2 / (2 * size);
+    // Accurate keeps the truncation far below double rounding
+    // Fast and Float rely on the Chebyshev fit, which is several times better than the Taylor bound
+    const int degree = degree_for(h, 62);
+    const int fast_degree = degree_for(h, 49);
+    const int float_degree = degree_for(h, 26);
+    const int precise_degree = degree_for(h, 110);
+    // CorrectlyRounded sums the terms below 2^-49 in plain double, their rounding errors stay under 2^-100
+    const int precise_head = degree_for(h, 49) + 1;
+
+    std::vector<double> hi(size), lo(size);
+    for (int j = 0; j < size; ++j) {
+        DoubleDouble t = exp2_dd(j, size);
+        hi[j] = t.hi;
+        lo[j] = t.lo;
+    }
+    std::vector<double> poly = to_double(exp_polynomial(h, degree));
+    std::vector<double> fast_poly = to_double(exp_polynomial(h, fast_degree));
+    std::vector<double> float_poly = to_double(exp_polynomial(h, float_degree));
+    std::vector<double> factorial_hi, factorial_lo;
+    for (DoubleDouble f = {1, 0}; static_cast<int>(factorial_hi.size()) <= precise_degree;) {
+        factorial_hi.push_back(f.hi);
+        factorial_lo.push_back(f.lo);
+        f = dd_div(f, static_cast<double>(factorial_hi.size()));
+    }
+
     std::ofstream write;
     write.open(argv[2]);
-    write << "#ifndef GENERATED_CONSTANT\n#define GENERATED_CONSTANT " << argv[1] << "\n#endif";
+    write << "#ifndef GENERATED_CONSTANT\n#define GENERATED_CONSTANT " << argv[1] << "\n#endif\n\n";
+
+    write << std::hexfloat;
+    write << "#ifndef GENERATED_EXP_TABLE\n#define GENERATED_EXP_TABLE\n\n";
+    write << "// generated by WriteNumberToFile, do not edit\n";
+    write << "namespace CustomMath {\nnamespace Generated {\n";
+    write << "    constexpr int exp_table_bits = " << bits << ";\n";
+    write << "    constexpr int exp_table_size = " << size << ";\n";
+    write << "    constexpr double exp_inv_step = " << static_cast<double>(size / ln2) << "; // N / ln2\n";
+    write << "    constexpr double exp_step_hi = " << static_cast<double>(ln2_hi / size) << "; // ln2 / N, split in two\n";
+    write << "    constexpr double exp_step_lo = " << static_cast<double>(ln2_lo / size) << ";\n";
+    write << "    constexpr int exp_poly_degree = " << degree << ";\n";
+    write_array(write, "exp_poly", poly);
+    write << "    constexpr int exp_poly_fast_degree = " << fast_degree << ";\n";
+    write_array(write, "exp_poly_fast", fast_poly);
+    write << "    constexpr int exp_poly_float_degree = " << float_degree << ";\n";
+    write_array(write, "exp_poly_float", float_poly);
+    write << "    constexpr int exp_precise_degree = " << precise_degree << ";\n";
+    write << "    constexpr int exp_precise_head = " << precise_head << ";\n";
+    write_array(write, "exp_inv_factorial_hi", factorial_hi);
+    write_array(write, "exp_inv_factorial_lo", factorial_lo);
+    write_array(write, "exp_table_hi", hi);
+    write_array(write, "exp_table_lo", lo);
+    write << "}\n}\n\n#endif\n";
     write.close();
-}
\ No newline at end of file
+}
@@ -1,10 +1,31 @@
 #include <iostream>
 #include <Config.h>
+#include <cstring>
 #include <string>
 #include <Math.h>
+#include "stream.h"
+
+// usage: App <x>                             prints e^x
+//        App --stream [--binary] [<file>]    e^x for every double of <file> or stdin, see stream.cxx
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::strcmp(argv[1], "--stream") == 0) {
+        Stream::Format format = Stream::Format::Text;
+        const char *path = nullptr;
+        for (int i = 2; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--binary") == 0)
+                format = Stream::Format::Binary;
+            else
+                path = argv[i];
+        }
+        return Stream::run(path, format);
+    }
+
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <x> | --stream [--binary] [<file>]" << std::endl;
+        return 1;
+    }
     std::cout << "e^" << argv[1] << " = " << CustomMath::exp(std::stod(argv[1])) << std::endl;
     std::cout << "Generated constant is " << CustomMath::print_generated() << std::endl;
-}
\ No newline at end of file
+}
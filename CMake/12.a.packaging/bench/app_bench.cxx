@@ -0,0 +1,174 @@
+// throughput of App in bulk mode against one App process per value
+//
+// usage: AppBench <path to App> [--values <n>] [--invocations <n>] [--min-speedup <factor>]
+//
+// writes <n> doubles as text and as binary into the working directory, then times
+//   per_value      `App <x>`, the way App was used so far, for --invocations of the values
+//   stream_mmap    `App --stream <file>`, the file is mapped
+//   stream_stdin   `App --stream < <file>`
+//   stream_binary  `App --stream --binary <file>`
+// results are printed as CSV: mode,values,seconds,values_per_s,input_mb_per_s
+// the streamed results are checked against the batch CustomMath::exp, a malformed line (3.14.15) has to make both
+// text modes fail, and the run fails when a stream mode is less than --min-speedup times faster per value than per_value
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <Math.h>
+
+namespace {
+    struct Result {
+        std::string mode;
+        std::size_t values;
+        double seconds;
+        std::size_t input_bytes;
+    };
+
+    double run(const std::string &command) {
+        auto start = std::chrono::steady_clock::now();
+        int status = std::system(command.c_str());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (status != 0) {
+            std::cerr << "failed: " << command << "\n";
+            std::exit(1);
+        }
+        return elapsed.count();
+    }
+
+    // true when the command exits with an error
+    bool fails(const std::string &command) {
+        if (std::system(command.c_str()) != 0)
+            return true;
+        std::cerr << "succeeded, should have failed: " << command << "\n";
+        return false;
+    }
+
+    std::string read_file(const char *path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    bool check_text(const char *path, const std::vector<double> &want) {
+        std::string text = read_file(path);
+        const char *p = text.data(), *end = text.data() + text.size();
+        for (std::size_t i = 0; i < want.size(); ++i) {
+            double got;
+            auto parsed = std::from_chars(p, end, got);
+            if (parsed.ec != std::errc() || got != want[i]) {
+                std::cerr << path << ": line " << i + 1 << " does not match CustomMath::exp\n";
+                return false;
+            }
+            p = parsed.ptr + 1;
+        }
+        return p >= end;
+    }
+
+    bool check_binary(const char *path, const std::vector<double> &want) {
+        std::string bytes = read_file(path);
+        if (bytes.size() != want.size() * sizeof(double) || std::memcmp(bytes.data(), want.data(), bytes.size()) != 0) {
+            std::cerr << path << ": does not match CustomMath::exp\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: AppBench <path to App> [--values <n>] [--invocations <n>] [--min-speedup <factor>]\n";
+        return 2;
+    }
+    const std::string app = std::string("\"") + argv[1] + "\"";
+    std::size_t values = 4000000, invocations = 200;
+    double min_speedup = 100;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--values" && i + 1 < argc)
+            values = std::stoul(argv[++i]);
+        else if (flag == "--invocations" && i + 1 < argc)
+            invocations = std::stoul(argv[++i]);
+        else if (flag == "--min-speedup" && i + 1 < argc)
+            min_speedup = std::stod(argv[++i]);
+        else {
+            std::cerr << "unknown option " << flag << "\n";
+            return 2;
+        }
+    }
+
+    std::vector<double> in(values), want(values);
+    for (std::size_t i = 0; i < values; ++i)
+        in[i] = -50.0 + 100.0 * double(i) / double(values) + 1e-7 * double(i % 977);
+    CustomMath::exp(in.data(), want.data(), values);
+
+    std::size_t text_bytes = 0;
+    {
+        std::ofstream text("app_bench_input.txt", std::ios::binary);
+        char line[32];
+        for (double x : in) {
+            char *last = std::to_chars(line, line + sizeof(line) - 1, x).ptr;
+            *last++ = '\n';
+            text.write(line, last - line);
+            text_bytes += last - line;
+        }
+        std::ofstream binary("app_bench_input.bin", std::ios::binary);
+        binary.write(reinterpret_cast<const char *>(in.data()), values * sizeof(double));
+        // every line is one value, a malformed line must not turn into several
+        std::ofstream malformed("app_bench_malformed.txt", std::ios::binary);
+        malformed << "3.14.15\n1-2\n";
+    }
+
+    std::vector<Result> results;
+    {
+        std::size_t n = invocations < values ? invocations : values;
+        double seconds = 0;
+        std::size_t bytes = 0;
+        char x[32];
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t j = i * (values / n);
+            *std::to_chars(x, x + sizeof(x) - 1, in[j]).ptr = '\0';
+            bytes += std::strlen(x) + 1;
+            seconds += run(app + " " + x + " > app_bench_per_value.txt");
+        }
+        results.push_back({"per_value", n, seconds, bytes});
+    }
+    results.push_back({"stream_mmap", values, run(app + " --stream app_bench_input.txt > app_bench_output.txt"), text_bytes});
+    bool ok = check_text("app_bench_output.txt", want);
+    results.push_back({"stream_stdin", values, run(app + " --stream < app_bench_input.txt > app_bench_output.txt"), text_bytes});
+    ok = check_text("app_bench_output.txt", want) && ok;
+    results.push_back({"stream_binary", values, run(app + " --stream --binary app_bench_input.bin > app_bench_output.bin"), values * sizeof(double)});
+    ok = check_binary("app_bench_output.bin", want) && ok;
+    ok = fails(app + " --stream app_bench_malformed.txt > app_bench_output.txt 2> app_bench_errors.txt") && ok;
+    ok = fails(app + " --stream < app_bench_malformed.txt > app_bench_output.txt 2> app_bench_errors.txt") && ok;
+
+    std::cout << "mode,values,seconds,values_per_s,input_mb_per_s\n";
+    for (const Result &r : results)
+        std::cout << r.mode << "," << r.values << "," << r.seconds << "," << r.values / r.seconds << ","
+                  << r.input_bytes / r.seconds / 1e6 << "\n";
+
+    const double per_value = results[0].values / results[0].seconds;
+    for (std::size_t i = 1; i < results.size(); ++i) {
+        double speedup = results[i].values / results[i].seconds / per_value;
+        std::cerr << results[i].mode << ": " << speedup << "x the values per second of per_value\n";
+        if (speedup < min_speedup) {
+            std::cerr << results[i].mode << " is below the required " << min_speedup << "x\n";
+            ok = false;
+        }
+    }
+
+    std::remove("app_bench_input.txt");
+    std::remove("app_bench_input.bin");
+    std::remove("app_bench_output.txt");
+    std::remove("app_bench_output.bin");
+    std::remove("app_bench_per_value.txt");
+    std::remove("app_bench_malformed.txt");
+    std::remove("app_bench_errors.txt");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,407 @@
+// latency and throughput of the CustomMath functions over L1, L2 and DRAM resident inputs
+//
+// usage: MathBench [--filter <function>] [--min-time <seconds>] [--threads <n>]
+//                  [--baseline <csv> --tolerance <percent>] [--write-baseline <csv>]
+//
+// results are printed as CSV: function,size,elements,latency_ns,throughput_meps,model_bytes_per_element,relative_error
+//   latency_ns        scalar functions: one call whose input depends on the previous result
+//                     batch functions and expressions: one call over the whole array
+//   throughput_meps   million elements per second over independent inputs
+//   model_bytes_per_element
+//                     analytical, not measured: the bytes of the arrays the function reads and writes per element,
+//                     counted from the code, throughput * bytes is the bandwidth this implies
+//                     the memory moves more (write allocate, the evictions of the expr_chain temporaries), the cache
+//                     misses of the calling thread are in the PerfScope.h report
+//   relative_error    reductions only: |result - exact| / |exact|, the exact result is summed in long double
+//
+// sum_<strategy>, dot_<strategy> and sum_float_<strategy> are the reductions with each CustomMath::Summation,
+// over values in [-0.5, 1), so that the cheapest strategy meeting an accuracy need can be picked from one run
+//
+// exp_correctly_rounded, exp (Accurate), exp_fast and exp_float are the accuracy tiers of CustomMath::exp<Precision>
+// expr_fused and expr_chain both compute out = a * b + exp(c):
+//   expr_fused uses the Array expression templates, one pass over the inputs
+//   expr_chain calls mult, exp and add separately and stores every intermediate array in full
+// with --baseline, the run fails when a throughput is more than --tolerance percent below the stored one of the same
+// function and element count, and when no result has a stored row to compare with
+// set CUSTOMMATH_ISA to compare the kernel tiers on one machine
+// --threads caps the threads of the batch calls (CustomMath::set_num_threads), the default follows OMP_NUM_THREADS
+// the l1 and l2 sizes and the alignment of the arrays follow the caches in Tuning.h
+// at exit, the hardware counters of every measurement are printed to stderr (PerfScope.h): IPC, cache and branch misses
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <Array.h>
+#include <Math.h>
+#include <Tuning.h>
+#include "PerfScope.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+    struct Size {
+        const char *name;
+        std::size_t elements;
+    };
+
+    // each size holds up to three arrays of doubles, which fill three quarters of the cache they are named after
+    const Size sizes[] = {
+        {"l1", Tuning::l1d / 4 / sizeof(double)},
+        {"l2", Tuning::l2 / 4 / sizeof(double)},
+        {"dram", 1 << 24}, // 128 MiB per array
+    };
+
+    // cache line aligned, so that the vector loops see the same alignment on every run
+    // arrays of several huge pages are aligned to them and backed by them where the system allows
+    template <typename T>
+    struct Aligned {
+        using value_type = T;
+
+        Aligned() = default;
+        template <typename U>
+        Aligned(const Aligned<U> &) {}
+
+        static std::size_t alignment(std::size_t bytes) {
+            return Tuning::huge_page && bytes >= 4 * Tuning::huge_page ? Tuning::huge_page : Tuning::cache_line;
+        }
+
+        T *allocate(std::size_t n) {
+            const std::size_t bytes = n * sizeof(T), align = alignment(bytes);
+            void *p = ::operator new((bytes + align - 1) / align * align, std::align_val_t(align));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+            if (align == Tuning::huge_page)
+                madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+            return static_cast<T *>(p);
+        }
+
+        void deallocate(T *p, std::size_t n) { ::operator delete(p, std::align_val_t(alignment(n * sizeof(T)))); }
+
+        template <typename U>
+        bool operator==(const Aligned<U> &) const { return true; }
+        template <typename U>
+        bool operator!=(const Aligned<U> &) const { return false; }
+    };
+
+    template <typename T>
+    using Vector = std::vector<T, Aligned<T>>;
+
+    struct Result {
+        std::string function;
+        std::string size;
+        std::size_t elements;
+        double latency_ns;
+        double throughput_meps;
+        std::size_t bytes_per_element;
+        double relative_error = -1; // not a reduction
+    };
+
+    // calls f until at least min_seconds have passed, returns seconds per call
+    // the timed calls are counted under region in the PerfScope report
+    double seconds_per_call(const std::function<void()> &f, double min_seconds, const std::string &region) {
+        using clock = std::chrono::steady_clock;
+        f(); // warm up caches and page in the output
+        PerfScope scope(region);
+        std::size_t reps = 0;
+        auto start = clock::now();
+        std::chrono::duration<double> elapsed{};
+        do {
+            f();
+            ++reps;
+            elapsed = clock::now() - start;
+        } while (elapsed.count() < min_seconds);
+        return elapsed.count() / reps;
+    }
+
+    // keeps the compiler from dropping a dependent chain whose result is otherwise unused
+    volatile double sink;
+
+    struct Data {
+        Vector<double> a, b, out;
+        Vector<float> a_f, out_f;
+
+        explicit Data(std::size_t n) : a(n), b(n), out(n), a_f(n), out_f(n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] = -50.0 + 100.0 * double(i) / double(n);
+                b[i] = 1.0 + 1e-9 * double(i % 1024);
+                a_f[i] = float(a[i]);
+            }
+        }
+    };
+
+    using Binary = double (*)(double, double);
+
+    // a scalar binary function, the chain feeds the result back as the left operand
+    Result measure_binary(const char *name, Binary f, const Size &size, Data &d, double min_seconds) {
+        const std::size_t n = size.elements;
+        double chain = seconds_per_call([&] {
+            double x = 1.0;
+            for (std::size_t i = 0; i < n; ++i)
+                x = f(x, d.b[i]);
+            sink = x;
+        }, min_seconds, std::string(name) + " " + size.name + " latency");
+        double independent = seconds_per_call([&] {
+            for (std::size_t i = 0; i < n; ++i)
+                d.out[i] = f(d.a[i], d.b[i]);
+        }, min_seconds, std::string(name) + " " + size.name);
+        return {name, size.name, n, chain / n * 1e9, n / independent / 1e6, 3 * sizeof(double)};
+    }
+
+    // a scalar unary function, the chain computes x = f(-x) which stays bounded for exp
+    Result measure_unary(const char *name, double (*f)(double), const Size &size, Data &d, double min_seconds) {
+        const std::size_t n = size.elements;
+        double chain = seconds_per_call([&] {
+            double x = 0.5;
+            for (std::size_t i = 0; i < n; ++i)
+                x = f(-x);
+            sink = x;
+        }, min_seconds, std::string(name) + " " + size.name + " latency");
+        double independent = seconds_per_call([&] {
+            for (std::size_t i = 0; i < n; ++i)
+                d.out[i] = f(d.a[i]);
+        }, min_seconds, std::string(name) + " " + size.name);
+        return {name, size.name, n, chain / n * 1e9, n / independent / 1e6, 2 * sizeof(double)};
+    }
+
+    // a batch function, latency is the time of one call over the whole array
+    Result measure_batch(const char *name, const std::function<void()> &f, const Size &size, std::size_t bytes, double min_seconds) {
+        double call = seconds_per_call(f, min_seconds, std::string(name) + " " + size.name);
+        return {name, size.name, size.elements, call * 1e9, size.elements / call / 1e6, bytes};
+    }
+
+    // out = a * b + exp(c), fused or as a chain of element-wise calls
+    void measure_expressions(std::vector<Result> &results, bool fused, bool chain, const Size &size, double min_seconds) {
+        const std::size_t n = size.elements;
+        CustomMath::Array<double> a(n), b(n), c(n), out(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            a[i] = 0.5 + double(i) / double(n);
+            b[i] = 2.0 - double(i) / double(n);
+            c[i] = -50.0 + 100.0 * double(i) / double(n);
+        }
+        if (fused)
+            results.push_back(measure_batch("expr_fused", [&] { out = a * b + exp(c); }, size, 4 * sizeof(double), min_seconds));
+        if (chain) {
+            Vector<double> product(n), exponential(n);
+            // mult: 2 reads + 1 write, exp: 1 + 1, add: 2 + 1
+            results.push_back(measure_batch("expr_chain", [&] {
+                for (std::size_t i = 0; i < n; ++i)
+                    product[i] = CustomMath::mult(a[i], b[i]);
+                CustomMath::exp(c.data(), exponential.data(), n);
+                for (std::size_t i = 0; i < n; ++i)
+                    out[i] = CustomMath::add(product[i], exponential[i]);
+            }, size, 8 * sizeof(double), min_seconds));
+        }
+    }
+
+    // the reductions of every strategy, errors against a compensated long double sum
+    void measure_reductions(std::vector<Result> &results, const std::function<bool(const char *)> &wanted, const Size &size,
+                            double min_seconds) {
+        using CustomMath::Summation;
+        const struct {
+            const char *name;
+            Summation strategy;
+        } strategies[] = {
+            {"naive", Summation::Naive},
+            {"simd", Summation::Simd},
+            {"pairwise", Summation::Pairwise},
+            {"compensated", Summation::Compensated},
+        };
+
+        bool any = false;
+        for (const auto &s : strategies)
+            for (const char *prefix : {"sum_", "dot_", "sum_float_"})
+                any = any || wanted((prefix + std::string(s.name)).c_str());
+        if (!any)
+            return;
+
+        const std::size_t n = size.elements;
+        Vector<double> x(n), y(n);
+        Vector<float> x_f(n);
+        std::uint64_t state = 1;
+        auto uniform = [&] {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return -0.5 + 1.5 * double(state >> 11) / double(std::uint64_t(1) << 53);
+        };
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = uniform();
+            y[i] = uniform();
+            x_f[i] = float(x[i]);
+        }
+
+        // Neumaier in long double, far more accurate than any double strategy
+        auto exact = [&](auto term) {
+            long double s = 0, c = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                long double v = term(i), t = s + v;
+                c += std::fabs(s) >= std::fabs(v) ? (s - t) + v : (v - t) + s;
+                s = t;
+            }
+            return s + c;
+        };
+        const long double sum_exact = exact([&](std::size_t i) { return (long double)x[i]; });
+        const long double dot_exact = exact([&](std::size_t i) { return (long double)x[i] * y[i]; });
+        const long double sum_float_exact = exact([&](std::size_t i) { return (long double)x_f[i]; });
+        auto error = [](long double got, long double want) { return double(std::fabs((got - want) / want)); };
+
+        for (const auto &s : strategies) {
+            std::string sum_name = std::string("sum_") + s.name;
+            std::string dot_name = std::string("dot_") + s.name;
+            std::string sum_float_name = std::string("sum_float_") + s.name;
+            if (wanted(sum_name.c_str())) {
+                double got = 0;
+                results.push_back(measure_batch(sum_name.c_str(), [&] { got = CustomMath::sum(x.data(), n, s.strategy); }, size, sizeof(double), min_seconds));
+                results.back().relative_error = error(got, sum_exact);
+            }
+            if (wanted(dot_name.c_str())) {
+                double got = 0;
+                results.push_back(measure_batch(dot_name.c_str(), [&] { got = CustomMath::dot(x.data(), y.data(), n, s.strategy); }, size, 2 * sizeof(double), min_seconds));
+                results.back().relative_error = error(got, dot_exact);
+            }
+            if (wanted(sum_float_name.c_str())) {
+                float got = 0;
+                results.push_back(measure_batch(sum_float_name.c_str(), [&] { got = CustomMath::sum(x_f.data(), n, s.strategy); }, size, sizeof(float), min_seconds));
+                results.back().relative_error = error(got, sum_float_exact);
+            }
+        }
+    }
+
+    double std_exp(double x) { return std::exp(x); }
+    double custom_exp(double x) { return CustomMath::exp(x); }
+    double exp_correctly_rounded(double x) { return CustomMath::exp<CustomMath::Precision::CorrectlyRounded>(x); }
+    double exp_fast(double x) { return CustomMath::exp<CustomMath::Precision::Fast>(x); }
+    double exp_float(double x) { return CustomMath::exp<CustomMath::Precision::Float>(x); }
+
+    std::vector<Result> run(const std::string &filter, double min_seconds) {
+        std::vector<Result> results;
+        auto wanted = [&](const char *name) { return filter.empty() || filter == name; };
+
+        for (const Size &size : sizes) {
+            Data d(size.elements);
+            if (wanted("add"))
+                results.push_back(measure_binary("add", CustomMath::add, size, d, min_seconds));
+            if (wanted("sub"))
+                results.push_back(measure_binary("sub", CustomMath::sub, size, d, min_seconds));
+            if (wanted("mult"))
+                results.push_back(measure_binary("mult", CustomMath::mult, size, d, min_seconds));
+            if (wanted("div"))
+                results.push_back(measure_binary("div", CustomMath::div, size, d, min_seconds));
+            if (wanted("exp"))
+                results.push_back(measure_unary("exp", custom_exp, size, d, min_seconds));
+            if (wanted("exp_correctly_rounded"))
+                results.push_back(measure_unary("exp_correctly_rounded", exp_correctly_rounded, size, d, min_seconds));
+            if (wanted("exp_fast"))
+                results.push_back(measure_unary("exp_fast", exp_fast, size, d, min_seconds));
+            if (wanted("exp_float"))
+                results.push_back(measure_unary("exp_float", exp_float, size, d, min_seconds));
+            if (wanted("std_exp"))
+                results.push_back(measure_unary("std_exp", std_exp, size, d, min_seconds));
+            if (wanted("exp_batch"))
+                results.push_back(measure_batch("exp_batch", [&] { CustomMath::exp(d.a.data(), d.out.data(), size.elements); }, size, 2 * sizeof(double), min_seconds));
+            if (wanted("exp_batch_float"))
+                results.push_back(measure_batch("exp_batch_float", [&] { CustomMath::exp(d.a_f.data(), d.out_f.data(), size.elements); }, size, 2 * sizeof(float), min_seconds));
+            if (wanted("expr_fused") || wanted("expr_chain"))
+                measure_expressions(results, wanted("expr_fused"), wanted("expr_chain"), size, min_seconds);
+            measure_reductions(results, wanted, size, min_seconds);
+        }
+        return results;
+    }
+
+    void write_csv(std::ostream &out, const std::vector<Result> &results) {
+        out << "function,size,elements,latency_ns,throughput_meps,model_bytes_per_element,relative_error\n";
+        for (const Result &r : results) {
+            out << r.function << "," << r.size << "," << r.elements << "," << r.latency_ns << "," << r.throughput_meps << ","
+                << r.bytes_per_element << ",";
+            if (r.relative_error >= 0)
+                out << r.relative_error;
+            out << "\n";
+        }
+    }
+
+    // function,elements -> throughput from a file written by --write-baseline
+    // the sizes follow the caches, so the element count identifies a row, not the size name
+    std::map<std::string, double> read_baseline(const std::string &path) {
+        std::map<std::string, double> baseline;
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line); // header
+        while (std::getline(in, line)) {
+            std::stringstream fields(line);
+            std::string function, size, elements, latency, throughput;
+            std::getline(fields, function, ',');
+            std::getline(fields, size, ',');
+            std::getline(fields, elements, ',');
+            std::getline(fields, latency, ',');
+            std::getline(fields, throughput, ',');
+            if (!throughput.empty())
+                baseline[function + "," + elements] = std::stod(throughput);
+        }
+        return baseline;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string filter, baseline_path, write_path;
+    double min_seconds = 0.1, tolerance = 50;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else if (flag == "--min-time" && i + 1 < argc)
+            min_seconds = std::stod(argv[++i]);
+        else if (flag == "--threads" && i + 1 < argc)
+            CustomMath::set_num_threads(std::stoi(argv[++i]));
+        else if (flag == "--baseline" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (flag == "--tolerance" && i + 1 < argc)
+            tolerance = std::stod(argv[++i]);
+        else if (flag == "--write-baseline" && i + 1 < argc)
+            write_path = argv[++i];
+        else {
+            std::cerr << "unknown option " << flag << "\n";
+            return 2;
+        }
+    }
+
+    std::cerr << "CustomMath kernel tier: " << CustomMath::simd_tier() << ", threads: " << CustomMath::num_threads() << "\n";
+    std::vector<Result> results = run(filter, min_seconds);
+    write_csv(std::cout, results);
+
+    if (!write_path.empty()) {
+        std::ofstream out(write_path);
+        write_csv(out, results);
+    }
+
+    if (baseline_path.empty())
+        return 0;
+
+    std::map<std::string, double> baseline = read_baseline(baseline_path);
+    bool ok = true;
+    std::size_t compared = 0;
+    for (const Result &r : results) {
+        auto found = baseline.find(r.function + "," + std::to_string(r.elements));
+        if (found == baseline.end())
+            continue;
+        ++compared;
+        double floor = found->second * (1 - tolerance / 100);
+        if (r.throughput_meps < floor) {
+            std::cerr << r.function << " (" << r.size << "): " << r.throughput_meps << " M elements/s is below "
+                      << floor << " (baseline " << found->second << " - " << tolerance << "%)\n";
+            ok = false;
+        }
+    }
+    // a check that compared nothing (a stale baseline, a --filter typo) must not pass
+    if (!compared) {
+        std::cerr << "no result has a row in " << baseline_path << ", regenerate it with --write-baseline\n";
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+#include "stream.h"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <Math.h>
+#include <Tuning.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define APP_HAVE_MMAP
+#endif
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// text:   doubles separated by newlines (any whitespace), parsed with std::from_chars
+//         one result per line, the shortest representation that reads back exactly (std::to_chars)
+// binary: native-endian doubles back to back, results written the same way
+//
+// files are mapped into memory and parsed in place, stdin is read in large chunks
+// values are collected into blocks for the batch CustomMath::exp, output is collected into one large buffer
+// so that the only per-value work is parsing, the exp kernel and formatting
+
+namespace Stream {
+    namespace {
+        // values per batch call, large enough for the SIMD kernels, the input and output blocks fill half of L1
+        constexpr std::size_t block = Tuning::l1d / 4 / sizeof(double);
+        constexpr std::size_t output_buffer = std::size_t(1) << 20;
+        constexpr std::size_t input_chunk = std::size_t(1) << 20;
+
+        class Writer {
+        public:
+            Writer() : buffer_(output_buffer) {}
+
+            // room for at least n more bytes
+            char *reserve(std::size_t n) {
+                if (used_ + n > buffer_.size())
+                    flush();
+                return buffer_.data() + used_;
+            }
+
+            void commit(std::size_t n) { used_ += n; }
+
+            bool flush() {
+                if (used_ && std::fwrite(buffer_.data(), 1, used_, stdout) != used_)
+                    failed_ = true;
+                used_ = 0;
+                return !failed_;
+            }
+
+            bool failed() const { return failed_; }
+
+        private:
+            std::vector<char> buffer_;
+            std::size_t used_ = 0;
+            bool failed_ = false;
+        };
+
+        class Processor {
+        public:
+            explicit Processor(Format format) : format_(format) {
+                in_.reserve(block);
+                out_.resize(block);
+            }
+
+            // parses every complete value of [data, data + size) and returns the number of bytes consumed
+            // last: the data ends here, a value may run up to the end
+            std::size_t consume(const char *data, std::size_t size, bool last) {
+                return format_ == Format::Text ? consume_text(data, size, last) : consume_binary(data, size);
+            }
+
+            bool finish() {
+                evaluate();
+                return writer_.flush() && !error_;
+            }
+
+            bool error() const { return error_ || writer_.failed(); }
+
+        private:
+            static bool space(char c) { return c == '\n' || c == ' ' || c == '\r' || c == '\t' || c == '\v' || c == '\f'; }
+
+            std::size_t consume_text(const char *data, std::size_t size, bool last) {
+                const char *p = data, *end = data + size;
+                while (!error_) {
+                    while (p != end && space(*p))
+                        ++p;
+                    if (p == end)
+                        break;
+                    // a value cut off at the end of a chunk is parsed again with the next one
+                    const char *stop = p;
+                    while (stop != end && !space(*stop))
+                        ++stop;
+                    if (stop == end && !last)
+                        break;
+                    // std::stod takes a leading +, std::from_chars does not
+                    if (*p == '+' && stop - p > 1 && p[1] != '-' && p[1] != '+')
+                        ++p;
+                    double x;
+                    auto parsed = std::from_chars(p, stop, x);
+                    // out of range values are rejected, like std::stod does
+                    // so is a value followed by anything but whitespace: 3.14.15 would otherwise become two values
+                    if (parsed.ec != std::errc() || parsed.ptr != stop) {
+                        std::cerr << "App: cannot parse value " << values_ + in_.size() + 1 << "\n";
+                        error_ = true;
+                        break;
+                    }
+                    push(x);
+                    p = stop;
+                }
+                return p - data;
+            }
+
+            std::size_t consume_binary(const char *data, std::size_t size) {
+                std::size_t count = size / sizeof(double);
+                for (std::size_t i = 0; i < count; ++i) {
+                    double x;
+                    std::memcpy(&x, data + i * sizeof(double), sizeof(double));
+                    push(x);
+                }
+                return count * sizeof(double);
+            }
+
+            void push(double x) {
+                in_.push_back(x);
+                if (in_.size() == block)
+                    evaluate();
+            }
+
+            void evaluate() {
+                const std::size_t n = in_.size();
+                CustomMath::exp(in_.data(), out_.data(), n);
+                if (format_ == Format::Binary) {
+                    std::memcpy(writer_.reserve(n * sizeof(double)), out_.data(), n * sizeof(double));
+                    writer_.commit(n * sizeof(double));
+                } else {
+                    // 24 characters hold the shortest form of any double, plus the newline
+                    const std::size_t longest = 25;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        char *first = writer_.reserve(longest);
+                        char *last = std::to_chars(first, first + longest - 1, out_[i]).ptr;
+                        *last++ = '\n';
+                        writer_.commit(last - first);
+                    }
+                }
+                values_ += n;
+                in_.clear();
+            }
+
+            Format format_;
+            std::vector<double> in_, out_;
+            std::size_t values_ = 0;
+            bool error_ = false;
+            Writer writer_;
+        };
+
+        int read_stdin(Processor &processor) {
+            std::vector<char> buffer(input_chunk);
+            std::size_t kept = 0;
+            while (true) {
+                if (kept == buffer.size())
+                    buffer.resize(buffer.size() * 2); // one value longer than the chunk
+                std::size_t read = std::fread(buffer.data() + kept, 1, buffer.size() - kept, stdin);
+                bool last = read == 0;
+                std::size_t available = kept + read;
+                std::size_t used = processor.consume(buffer.data(), available, last);
+                if (processor.error())
+                    return 1;
+                kept = available - used;
+                if (last) {
+                    if (kept) {
+                        std::cerr << "App: " << kept << " trailing bytes do not form a double\n";
+                        return 1;
+                    }
+                    break;
+                }
+                std::memmove(buffer.data(), buffer.data() + used, kept);
+            }
+            return processor.finish() ? 0 : 1;
+        }
+
+        int read_file(const char *path, Processor &processor) {
+#ifdef APP_HAVE_MMAP
+            int fd = open(path, O_RDONLY);
+            struct stat info;
+            if (fd < 0 || fstat(fd, &info) != 0) {
+                std::cerr << "App: cannot open " << path << "\n";
+                if (fd >= 0)
+                    close(fd);
+                return 1;
+            }
+            std::size_t size = static_cast<std::size_t>(info.st_size);
+            void *mapped = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+            close(fd);
+            if (size && mapped == MAP_FAILED) {
+                std::cerr << "App: cannot map " << path << "\n";
+                return 1;
+            }
+            if (mapped)
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            const char *data = static_cast<const char *>(mapped);
+            std::size_t used = size ? processor.consume(data, size, true) : 0;
+            if (mapped)
+                munmap(mapped, size);
+            if (processor.error())
+                return 1;
+            if (used != size) {
+                std::cerr << "App: " << size - used << " trailing bytes do not form a double\n";
+                return 1;
+            }
+            return processor.finish() ? 0 : 1;
+#else
+            // no mmap, read the file like stdin
+            if (!std::freopen(path, "rb", stdin)) {
+                std::cerr << "App: cannot open " << path << "\n";
+                return 1;
+            }
+            return read_stdin(processor);
+#endif
+        }
+    }
+
+    int run(const char *path, Format format) {
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        Processor processor(format);
+        return path ? read_file(path, processor) : read_stdin(processor);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef stream_h
+#define stream_h
+
+// bulk mode of App: e^x for every double of a file or of stdin, see stream.cxx
+
+namespace Stream {
+    enum class Format { Text, Binary };
+
+    // path == nullptr reads stdin, results go to stdout in the same format
+    // returns the process exit code, errors are reported on stderr
+    int run(const char *path, Format format);
+}
+
+#endif
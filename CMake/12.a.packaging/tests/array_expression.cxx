@@ -0,0 +1,65 @@
+// checks that the fused CustomMath::Array expressions match the element-wise CustomMath calls
+#include <cmath>
+#include <iostream>
+#include <Array.h>
+#include <Math.h>
+
+namespace {
+    int failures = 0;
+
+    template <typename T>
+    void expect(const char *what, const CustomMath::Array<T> &got, const CustomMath::Array<T> &want) {
+        for (std::size_t i = 0; i < want.size(); ++i) {
+            if (got[i] != want[i] && !(std::isnan(got[i]) && std::isnan(want[i]))) {
+                std::cout << what << ": element " << i << " is " << got[i] << ", expected " << want[i] << "\n";
+                ++failures;
+                return;
+            }
+        }
+        std::cout << what << ": ok\n";
+    }
+}
+
+int main() {
+    // not a multiple of the block size, so the last block is partial
+    const std::size_t n = 1000;
+    CustomMath::Array<double> a(n), b(n), c(n), want(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = 0.5 + double(i) / n;
+        b[i] = 2.0 - double(i) / n;
+        c[i] = -20.0 + 40.0 * double(i) / n;
+    }
+
+    // the batch exp the expression uses, applied element by element
+    CustomMath::Array<double> exp_c(n);
+    CustomMath::exp(c.data(), exp_c.data(), n);
+
+    CustomMath::Array<double> out(n);
+    out = a * b + exp(c);
+    for (std::size_t i = 0; i < n; ++i)
+        want[i] = CustomMath::add(CustomMath::mult(a[i], b[i]), exp_c[i]);
+    expect("a * b + exp(c)", out, want);
+
+    CustomMath::Array<double> mixed = 2.0 * a - b / 4.0 + -c;
+    for (std::size_t i = 0; i < n; ++i)
+        want[i] = CustomMath::add(CustomMath::sub(CustomMath::mult(2.0, a[i]), CustomMath::div(b[i], 4.0)), -c[i]);
+    expect("2 * a - b / 4 + -c", mixed, want);
+
+    // the target is also an operand
+    CustomMath::Array<double> alias = c;
+    alias = CustomMath::mult(alias, a) + exp(alias);
+    for (std::size_t i = 0; i < n; ++i)
+        want[i] = CustomMath::add(CustomMath::mult(c[i], a[i]), exp_c[i]);
+    expect("c = c * a + exp(c)", alias, want);
+
+    CustomMath::Array<float> f(n), f_exp(n);
+    for (std::size_t i = 0; i < n; ++i)
+        f[i] = float(c[i]);
+    CustomMath::exp(f.data(), f_exp.data(), n);
+    CustomMath::Array<float> f_out = exp(f) * 0.5f, f_want(n);
+    for (std::size_t i = 0; i < n; ++i)
+        f_want[i] = f_exp[i] * 0.5f;
+    expect("exp(f) * 0.5f", f_out, f_want);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// checks CustomMath::exp, batch and scalar, against std::exp across the whole floating point domain
+// the error is measured in units in the last place (ULP) of the result
+// double results are compared to expl rounded to double where long double is wider than double,
+// which is the exactly rounded result unless expl lands too close to the midpoint of two doubles
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include <Math.h>
+
+namespace {
+    // maps a floating point value onto a monotonic integer line, so that neighbours differ by 1
+    std::int64_t ordered(double x) {
+        std::int64_t i;
+        std::memcpy(&i, &x, sizeof(double));
+        return i < 0 ? std::numeric_limits<std::int64_t>::min() - i : i;
+    }
+
+    std::int64_t ordered(float x) {
+        std::int32_t i;
+        std::memcpy(&i, &x, sizeof(float));
+        return i < 0 ? std::numeric_limits<std::int32_t>::min() - std::int64_t(i) : i;
+    }
+
+    template <typename T>
+    struct Report {
+        const char *name;
+        std::int64_t max_ulp = 0;
+        T worst_input = 0;
+        std::size_t checked = 0;
+        std::size_t special_failures = 0;
+        std::size_t undecided = 0;
+    };
+
+    // expl is trusted to a few ulp of long double, 2^-60 relative leaves a margin for that
+    const bool wide_long_double = std::numeric_limits<long double>::digits >= 64;
+
+    double reference(double x) { return wide_long_double ? static_cast<double>(std::exp(static_cast<long double>(x))) : std::exp(x); }
+    float reference(float x) { return static_cast<float>(std::exp(static_cast<double>(x))); }
+
+    // the batch functions, called in odd chunk lengths so the vector loops and their tails are both exercised
+    template <typename T>
+    void batch(const std::vector<T> &in, std::vector<T> &out) {
+        const std::size_t chunk = 1021;
+        for (std::size_t i = 0; i < in.size(); i += chunk) {
+            std::size_t n = in.size() - i < chunk ? in.size() - i : chunk;
+            CustomMath::exp(in.data() + i, out.data() + i, n);
+        }
+    }
+
+    // whether the long double result is far enough from a midpoint to round to the exactly rounded double
+    bool decided(double x) {
+        long double v = std::exp(static_cast<long double>(x));
+        double r = static_cast<double>(v);
+        if (v == r)
+            return true;
+        long double neighbour = std::nextafter(r, v > r ? HUGE_VAL : -HUGE_VAL);
+        long double midpoint = (r + neighbour) / 2;
+        return std::fabs(v - midpoint) > std::ldexp(v, -60);
+    }
+
+    // one of the table-driven scalar tiers
+    template <double (*f)(double)>
+    void scalar(const std::vector<double> &in, std::vector<double> &out) {
+        for (std::size_t i = 0; i < in.size(); ++i)
+            out[i] = f(in[i]);
+    }
+
+    // exact: skip the inputs whose reference might be rounded the wrong way, for a 0 ulp bound
+    template <typename T>
+    void check(Report<T> &report, const std::vector<T> &in, void (*evaluate)(const std::vector<T> &, std::vector<T> &), bool exact = false) {
+        std::vector<T> out(in.size());
+        evaluate(in, out);
+
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            T x = in[i], got = out[i], want = reference(x);
+            if (exact && !decided(x)) {
+                ++report.undecided;
+                continue;
+            }
+            ++report.checked;
+            if (std::isnan(want) || std::isinf(want) || want == 0) {
+                bool same = std::isnan(want) ? std::isnan(got) : got == want;
+                // underflow to zero may land one subnormal step away
+                if (!same && !(want == 0 && std::abs(ordered(got)) <= 1)) {
+                    if (report.special_failures++ < 10)
+                        std::cout << report.name << ": exp(" << x << ") = " << got << ", expected " << want << "\n";
+                }
+                continue;
+            }
+            std::int64_t ulp = std::abs(ordered(got) - ordered(want));
+            if (ulp > report.max_ulp) {
+                report.max_ulp = ulp;
+                report.worst_input = x;
+            }
+        }
+    }
+
+    template <typename T>
+    std::vector<T> special_values() {
+        using limits = std::numeric_limits<T>;
+        return {
+            T(0), -T(0), T(1), T(-1),
+            limits::infinity(), -limits::infinity(), limits::quiet_NaN(), -limits::quiet_NaN(),
+            limits::max(), limits::lowest(), limits::min(), -limits::min(),
+            limits::denorm_min(), -limits::denorm_min(), limits::epsilon(), -limits::epsilon(),
+        };
+    }
+
+    template <typename T>
+    bool report(const Report<T> &r, std::int64_t tolerance) {
+        bool ok = r.max_ulp <= tolerance && r.special_failures == 0;
+        std::cout.precision(std::numeric_limits<T>::max_digits10);
+        std::cout << r.name << ": " << r.checked << " inputs, max error " << r.max_ulp << " ulp at x = " << r.worst_input
+                  << ", " << r.special_failures << " special value failures";
+        if (r.undecided)
+            std::cout << ", " << r.undecided << " undecided inputs skipped";
+        std::cout << " -> " << (ok ? "ok" : "FAILED") << "\n";
+        return ok;
+    }
+}
+
+int main() {
+    // double: a sparse walk over every bit pattern, then a dense walk over the finite range of exp
+    using CustomMath::Precision;
+    Report<double> d{"double"}, s{"scalar double"}, correctly_rounded{"CorrectlyRounded"}, fast{"Fast"}, single{"Float"};
+    {
+        std::vector<double> in = special_values<double>();
+        for (std::uint64_t bits = 0; bits < (std::uint64_t(1) << 63); bits += (std::uint64_t(1) << 40) + 12345) {
+            double x;
+            std::memcpy(&x, &bits, sizeof(double));
+            in.push_back(x);
+            in.push_back(-x);
+        }
+        for (double x : {709.782712893384, 709.78271289338397, -708.3964185322641, -745.1332191019411, -745.1332191019412})
+            for (int i = -1000; i <= 1000; ++i)
+                in.push_back(x + i * std::numeric_limits<double>::epsilon() * 512);
+        const std::size_t dense = 4000000;
+        for (std::size_t i = 0; i < dense; ++i)
+            in.push_back(-746.0 + 1456.0 * i / dense);
+        check(d, in, batch<double>);
+        check(s, in, scalar<CustomMath::exp>);
+        check(correctly_rounded, in, scalar<CustomMath::exp<Precision::CorrectlyRounded>>, wide_long_double);
+        check(fast, in, scalar<CustomMath::exp<Precision::Fast>>);
+        check(single, in, scalar<CustomMath::exp<Precision::Float>>);
+    }
+
+    // float: a strided walk over every bit pattern
+    Report<float> f{"float"};
+    {
+        std::vector<float> in = special_values<float>();
+        for (std::uint64_t bits = 0; bits < (std::uint64_t(1) << 32); bits += 61) {
+            std::uint32_t b = static_cast<std::uint32_t>(bits);
+            float x;
+            std::memcpy(&x, &b, sizeof(float));
+            in.push_back(x);
+        }
+        check(f, in, batch<float>);
+    }
+
+    std::cout << "kernel tier: " << CustomMath::simd_tier() << "\n";
+    bool ok = report(d, 2);
+    ok = report(s, 1) && ok;
+    ok = report(f, 2) && ok;
+    // the documented bounds of Math.h, without a wider long double the reference itself may be 1 ulp off
+    ok = report(correctly_rounded, wide_long_double ? 0 : 1) && ok;
+    ok = report(fast, 4) && ok;
+    ok = report(single, std::int64_t(1) << 29) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+// checks that batch calls split across threads give the same bits as a single-threaded call
+// sizes straddle the grain of parallel.cxx, offsets move the chunk boundaries off the cache lines
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <Math.h>
+
+namespace {
+    int failures = 0;
+
+    template <typename T>
+    void compare(const char *type, std::size_t n, std::size_t offset, bool in_place) {
+        std::vector<T> in(n + offset), serial(n + offset), threaded(n + offset);
+        for (std::size_t i = 0; i < in.size(); ++i)
+            in[i] = T(-80.0 + 160.0 * double(i) / double(in.size()));
+
+        CustomMath::set_num_threads(1);
+        CustomMath::exp(in.data() + offset, serial.data() + offset, n);
+
+        CustomMath::set_num_threads(4);
+        if (in_place) {
+            threaded = in;
+            CustomMath::exp(threaded.data() + offset, threaded.data() + offset, n);
+        } else {
+            CustomMath::exp(in.data() + offset, threaded.data() + offset, n);
+        }
+
+        if (n && std::memcmp(serial.data() + offset, threaded.data() + offset, n * sizeof(T)) != 0) {
+            std::cout << type << ": n = " << n << ", offset " << offset << (in_place ? ", in place" : "") << " differs\n";
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    CustomMath::set_num_threads(3);
+    int threads = CustomMath::num_threads();
+    // builds without OpenMP always report a single thread
+    if (threads != 3 && threads != 1) {
+        std::cout << "set_num_threads(3) gave " << threads << " threads\n";
+        ++failures;
+    }
+
+    for (std::size_t n : {std::size_t(0), std::size_t(1), std::size_t(1000), std::size_t(32767), std::size_t(65536 * 3 + 13), std::size_t(1 << 22)}) {
+        for (std::size_t offset : {0, 1, 3}) {
+            compare<double>("double", n, offset, false);
+            compare<float>("float", n, offset, false);
+        }
+        compare<double>("double", n, 0, true);
+        compare<float>("float", n, 0, true);
+    }
+
+    CustomMath::set_num_threads(0);
+    std::cout << "default threads: " << CustomMath::num_threads() << ", " << failures << " failures\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// checks CustomMath::sum, dot and mean against the error bound of every Summation strategy (see Math.h)
+// the inputs are scaled integers, so the exact results are known without any wider floating point type
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Math.h>
+
+namespace {
+    using CustomMath::Summation;
+
+    const Summation strategies[] = {Summation::Naive, Summation::Simd, Summation::Pairwise, Summation::Compensated};
+    const char *const names[] = {"Naive", "Simd", "Pairwise", "Compensated"};
+
+    int failures = 0;
+
+    std::uint64_t state = 12345;
+    std::int64_t random(std::int64_t range) { // uniform in [-range, range)
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<std::int64_t>((state >> 11) % std::uint64_t(2 * range)) - range;
+    }
+
+    // bound on |got - exact| of a strategy, u the unit roundoff, s the exact result, S the sum of |terms|
+    double bound(Summation strategy, std::size_t n, double u, double s, double S) {
+        switch (strategy) {
+        case Summation::Naive: return (double(n) - 1) * u * S;
+        case Summation::Simd: return (double(n) / 16 + 4) * u * S;
+        case Summation::Pairwise: return (std::log2(double(n) + 1) + 16) * u * S;
+        default: return 2 * u * std::fabs(s) + 4 * double(n) * u * u * S;
+        }
+    }
+
+    template <typename T>
+    void expect(const char *what, Summation strategy, T got, double exact, double S, std::size_t n) {
+        const double u = std::numeric_limits<T>::epsilon() / 2;
+        double error = std::fabs(double(got) - exact);
+        double limit = bound(strategy, n, u, exact, S);
+        bool ok = error <= limit;
+        std::cout << what << " " << names[int(strategy)] << ": error " << error << ", bound " << limit << (ok ? "" : " FAILED") << "\n";
+        failures += !ok;
+    }
+
+    // big integers next to their negation, shuffled with small multiples of 2^-small_bits:
+    // the exact sum is the sum of the small values, tiny next to S
+    template <typename T>
+    void ill_conditioned(const char *type, std::size_t n, int big_bits, int small_bits) {
+        std::vector<T> x(n), ones(n, T(1));
+        const std::size_t small = n / 8 + 1, pairs = (n - small) / 2;
+        std::int64_t total = 0;
+        for (std::size_t i = 0; i < pairs; ++i) {
+            x[2 * i] = T(random(std::int64_t(1) << big_bits));
+            x[2 * i + 1] = -x[2 * i];
+        }
+        for (std::size_t i = 2 * pairs; i < 2 * pairs + small && i < n; ++i) {
+            std::int64_t m = random(std::int64_t(1) << small_bits);
+            x[i] = T(std::ldexp(double(m), -small_bits));
+            total += m;
+        }
+        for (std::size_t i = n; i > 1; --i)
+            std::swap(x[i - 1], x[static_cast<std::size_t>(random(std::int64_t(i)) + std::int64_t(i)) / 2]);
+        double exact = std::ldexp(double(total), -small_bits), S = 0;
+        for (T v : x)
+            S += std::fabs(double(v));
+
+        std::string what = std::string(type) + " ill-conditioned sum";
+        std::string what_dot = std::string(type) + " ill-conditioned dot";
+        for (Summation s : strategies) {
+            expect<T>(what.c_str(), s, CustomMath::sum(x.data(), n, s), exact, S, n);
+            expect<T>(what_dot.c_str(), s, CustomMath::dot(x.data(), ones.data(), n, s), exact, S, n);
+        }
+    }
+
+    // positive values, every strategy is accurate relative to the result itself
+    template <typename T>
+    void well_conditioned(const char *type, std::size_t n, int bits) {
+        std::vector<T> x(n);
+        std::int64_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::int64_t m = random(std::int64_t(1) << bits) + (std::int64_t(1) << bits);
+            x[i] = T(std::ldexp(double(m), -bits));
+            total += m;
+        }
+        double exact = std::ldexp(double(total), -bits);
+        std::string what = std::string(type) + " positive sum";
+        for (Summation s : strategies) {
+            T sum = CustomMath::sum(x.data(), n, s);
+            expect<T>(what.c_str(), s, sum, exact, exact, n);
+            if (CustomMath::mean(x.data(), n, s) != sum / T(n)) {
+                std::cout << type << " mean " << names[int(s)] << " is not sum / n FAILED\n";
+                ++failures;
+            }
+        }
+    }
+
+    // 1 + e times 1 - e is 1 - e^2, which rounds to 1, only Compensated keeps the lost product
+    template <typename T>
+    void lost_product(const char *type, int e_bits) {
+        const T e = T(std::ldexp(1.0, -e_bits));
+        T a[] = {T(1) + e, T(-1)}, b[] = {T(1) - e, T(1)};
+        T got = CustomMath::dot(a, b, 2, Summation::Compensated);
+        bool ok = double(got) == -std::ldexp(1.0, -2 * e_bits);
+        std::cout << type << " lost product Compensated: " << got << (ok ? "" : " FAILED") << "\n";
+        failures += !ok;
+    }
+
+    template <typename T>
+    void edge_cases(const char *type) {
+        T one[] = {T(3)};
+        T nan[] = {T(1), std::numeric_limits<T>::quiet_NaN(), T(2)};
+        const T inf = std::numeric_limits<T>::infinity();
+        T infinite[] = {T(1), inf, T(2)}, opposite[] = {inf, T(1), -inf};
+        for (Summation s : strategies) {
+            bool ok = CustomMath::sum(one, 0, s) == T(0) && std::isnan(CustomMath::mean(one, 0, s)) &&
+                      CustomMath::sum(one, 1, s) == T(3) && CustomMath::dot(one, one, 1, s) == T(9) &&
+                      std::isnan(CustomMath::sum(nan, 3, s)) && CustomMath::sum(infinite, 3, s) == inf &&
+                      CustomMath::dot(infinite, infinite, 3, s) == inf && std::isnan(CustomMath::sum(opposite, 3, s));
+            if (!ok) {
+                std::cout << type << " edge cases " << names[int(s)] << " FAILED\n";
+                ++failures;
+            }
+        }
+    }
+}
+
+int main() {
+    for (std::size_t n : {std::size_t(3), std::size_t(100), std::size_t(1000), std::size_t(1 << 20) + 5}) {
+        std::cout << "n = " << n << "\n";
+        ill_conditioned<double>("double", n, 40, 20);
+        ill_conditioned<float>("float", n, 12, 6);
+        well_conditioned<double>("double", n, 30);
+        well_conditioned<float>("float", n, 10);
+    }
+    lost_product<double>("double", 30);
+    lost_product<float>("float", 13);
+    edge_cases<double>("double");
+    edge_cases<float>("float");
+    std::cout << failures << " failures\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// run by Tuning.cmake when configuring, prints what the build machine offers as KEY=VALUE lines
+// sizes are in bytes, 0 when unknown
+//   CACHE_LINE  L1D  L2  LLC  HUGE_PAGE (0 without transparent or large page support)
+//   SIMD        the instruction sets the CPU and the OS support, separated by ';'
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(_WIN32)
+#include <intrin.h>
+#include <immintrin.h>
+#include <vector>
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <unistd.h>
+#endif
+
+namespace {
+    struct Caches {
+        std::size_t line = 0, l1d = 0, l2 = 0, llc = 0;
+    };
+
+#if defined(__linux__)
+    std::string read_line(const std::string &path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    // "48K", "2048K", "32M"
+    std::size_t parse_size(const std::string &text) {
+        std::size_t value = 0, i = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+            value = value * 10 + (text[i] - '0');
+        if (i < text.size() && text[i] == 'K')
+            value <<= 10;
+        else if (i < text.size() && text[i] == 'M')
+            value <<= 20;
+        return value;
+    }
+
+    Caches caches() {
+        Caches c;
+        for (int index = 0; index < 16; ++index) {
+            std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+            std::string level = read_line(dir + "level"), type = read_line(dir + "type");
+            if (level.empty())
+                break;
+            if (type == "Instruction")
+                continue;
+            std::size_t size = parse_size(read_line(dir + "size"));
+            if (level == "1") {
+                c.l1d = size;
+                c.line = parse_size(read_line(dir + "coherency_line_size"));
+            } else if (level == "2") {
+                c.l2 = size;
+            }
+            if (level != "1" && size > c.llc)
+                c.llc = size;
+        }
+#if defined(_SC_LEVEL1_DCACHE_LINESIZE)
+        // older kernels without the cache directory
+        if (!c.line)
+            c.line = static_cast<std::size_t>(sysconf(_SC_LEVEL1_DCACHE_LINESIZE) > 0 ? sysconf(_SC_LEVEL1_DCACHE_LINESIZE) : 0);
+        if (!c.l1d)
+            c.l1d = static_cast<std::size_t>(sysconf(_SC_LEVEL1_DCACHE_SIZE) > 0 ? sysconf(_SC_LEVEL1_DCACHE_SIZE) : 0);
+        if (!c.l2)
+            c.l2 = static_cast<std::size_t>(sysconf(_SC_LEVEL2_CACHE_SIZE) > 0 ? sysconf(_SC_LEVEL2_CACHE_SIZE) : 0);
+#endif
+        return c;
+    }
+
+    std::size_t huge_page() {
+        std::string enabled = read_line("/sys/kernel/mm/transparent_hugepage/enabled");
+        if (enabled.find("[never]") != std::string::npos || enabled.empty())
+            return 0;
+        std::size_t size = parse_size(read_line("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size"));
+        return size ? size : std::size_t(2) << 20;
+    }
+#elif defined(__APPLE__)
+    std::size_t sysctl_size(const char *name) {
+        std::int64_t value = 0;
+        std::size_t length = sizeof(value);
+        return sysctlbyname(name, &value, &length, nullptr, 0) == 0 ? static_cast<std::size_t>(value) : 0;
+    }
+
+    Caches caches() {
+        Caches c;
+        c.line = sysctl_size("hw.cachelinesize");
+        c.l1d = sysctl_size("hw.l1dcachesize");
+        c.l2 = sysctl_size("hw.l2cachesize");
+        c.llc = sysctl_size("hw.l3cachesize");
+        if (!c.llc)
+            c.llc = c.l2;
+        return c;
+    }
+
+    std::size_t huge_page() { return 0; }
+#elif defined(_WIN32)
+    Caches caches() {
+        Caches c;
+        DWORD length = 0;
+        GetLogicalProcessorInformation(nullptr, &length);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (!GetLogicalProcessorInformation(info.data(), &length))
+            return c;
+        for (const auto &entry : info) {
+            if (entry.Relationship != RelationCache || entry.Cache.Type == CacheInstruction)
+                continue;
+            std::size_t size = entry.Cache.Size;
+            if (entry.Cache.Level == 1) {
+                c.l1d = size;
+                c.line = entry.Cache.LineSize;
+            } else if (entry.Cache.Level == 2) {
+                c.l2 = size;
+            }
+            if (entry.Cache.Level > 1 && size > c.llc)
+                c.llc = size;
+        }
+        return c;
+    }
+
+    std::size_t huge_page() { return GetLargePageMinimum(); }
+#else
+    Caches caches() { return {}; }
+    std::size_t huge_page() { return 0; }
+#endif
+
+    std::string simd() {
+        std::string sets;
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2"))
+            sets += "sse2;";
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            sets += "avx2;";
+        if (__builtin_cpu_supports("avx512f"))
+            sets += "avx512;";
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int leaf1[4], leaf7[4];
+        __cpuid(leaf1, 1);
+        __cpuidex(leaf7, 7, 0);
+        unsigned long long xcr0 = ((leaf1[2] >> 27) & 1) ? _xgetbv(0) : 0;
+        if ((leaf1[3] >> 26) & 1)
+            sets += "sse2;";
+        if ((xcr0 & 0x6) == 0x6 && ((leaf7[1] >> 5) & 1) && ((leaf1[2] >> 12) & 1))
+            sets += "avx2;";
+        if ((xcr0 & 0xe6) == 0xe6 && ((leaf7[1] >> 16) & 1))
+            sets += "avx512;";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+        sets += "neon;";
+#endif
+        if (!sets.empty())
+            sets.pop_back();
+        return sets;
+    }
+}
+
+int main() {
+    Caches c = caches();
+    std::printf("CACHE_LINE=%zu\n", c.line);
+    std::printf("L1D=%zu\n", c.l1d);
+    std::printf("L2=%zu\n", c.l2);
+    std::printf("LLC=%zu\n", c.llc);
+    std::printf("HUGE_PAGE=%zu\n", huge_page());
+    std::printf("SIMD=%s\n", simd().c_str());
+    return 0;
+}
@@ -3,9 +3,18 @@
 #include <string>
 #ifdef USE_MATH
 #include <Math.h>
+#include <Tuning.h>
 #endif
 
 int main(int argc, char *argv[]) {
+    #ifdef USE_MATH
+    if (argc < 2) {
+        std::cout << "cache line " << Tuning::cache_line << " B, L1d " << Tuning::l1d << " B, L2 " << Tuning::l2
+                  << " B, LLC " << Tuning::llc << " B, huge page " << Tuning::huge_page << " B, SIMD '"
+                  << Tuning::simd << "'" << std::endl;
+        return 0;
+    }
+    #endif
     std::cout<<"e^"<< argv[1] << " = " <<
         #ifdef USE_MATH
         CustomMath::exp(std::stod(argv[1]))
@@ -16,6 +16,35 @@ namespace CustomMath
 #endif
     }
 
+    void exp(const double *in, double *out, std::size_t n)
+    {
+#ifdef USE_MATH
+        Inner::exp(in, out, n);
+#else
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::exp(in[i]);
+#endif
+    }
+
+    void exp(const float *in, float *out, std::size_t n)
+    {
+#ifdef USE_MATH
+        Inner::exp(in, out, n);
+#else
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::exp(in[i]);
+#endif
+    }
+
+    const char *simd_tier()
+    {
+#ifdef USE_MATH
+        return Inner::simd_tier();
+#else
+        return "std";
+#endif
+    }
+
     double print_generated() {
 #ifdef USE_MATH
         return Inner::print_generated();
@@ -1,6 +1,8 @@
 #ifndef Math_h
 #define Math_h
 
+#include <cstddef>
+
 #if defined(_WIN32)
 #  if defined(EXPORTING_MATH)
 #    define DECLSPEC __declspec(dllexport)
@@ -13,6 +15,13 @@
 
 namespace CustomMath {
     double DECLSPEC exp(double);
+    // batch versions, out[i] = e^in[i] for i < n
+    // in and out may be the same array but must not partially overlap
+    void DECLSPEC exp(const double *in, double *out, std::size_t n);
+    void DECLSPEC exp(const float *in, float *out, std::size_t n);
+    // name of the instruction set tier the batch functions run on, chosen when the library loads
+    // CUSTOMMATH_ISA=scalar|sse2|avx2|avx512 in the environment caps the tier
+    DECLSPEC const char *simd_tier();
     double DECLSPEC print_generated();
 }
 
@@ -1,6 +1,7 @@
 #include "Math.h"
 #include <cmath>
 #include "Generated.h"
+#include "exp_kernels.h"
 
 namespace CustomMath {
     // note the addition of the Inner namespace
@@ -13,6 +14,17 @@ namespace CustomMath {
             #endif
         }
 
+        // the kernels are picked at runtime, see dispatch.cxx
+        void exp(const double *in, double *out, std::size_t n) {
+            Kernels::dispatch().exp_double(in, out, n);
+        }
+
+        void exp(const float *in, float *out, std::size_t n) {
+            Kernels::dispatch().exp_float(in, out, n);
+        }
+
+        const char *simd_tier() { return Kernels::dispatch().name; }
+
         double print_generated() { return GENERATED_CONSTANT; }
     }
 
@@ -1,9 +1,14 @@
 # ifndef arithmetics_h
 # define arithmetics_h
 
+#include <cstddef>
+
 namespace CustomMath {
     namespace Inner {
         double exp(double);
+        void exp(const double *, double *, std::size_t);
+        void exp(const float *, float *, std::size_t);
+        const char *simd_tier();
         double print_generated();
     }
 }
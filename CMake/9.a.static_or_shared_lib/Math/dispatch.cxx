@@ -0,0 +1,126 @@
+#include "exp_kernels.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <cctype>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// the library is compiled once for every tier listed in Math/CMakeLists.txt,
+// the fastest tier the running CPU supports is chosen once, when the library is loaded
+//
+// set CUSTOMMATH_ISA=scalar|sse2|avx2|avx512 to force a tier, e.g. to benchmark or test each one on the same machine
+// a forced tier that the CPU (or the build) does not support falls back to the best one below it
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Kernels {
+            namespace {
+                enum Tier { Scalar, SSE2, AVX2, AVX512, TierCount };
+
+                const char *const tier_names[TierCount] = {"scalar", "sse2", "avx2", "avx512"};
+
+                bool compiled(Tier t) {
+                    switch (t) {
+                    case Scalar: return true;
+#ifdef MATH_HAVE_SSE2
+                    case SSE2: return true;
+#endif
+#ifdef MATH_HAVE_AVX2
+                    case AVX2: return true;
+#endif
+#ifdef MATH_HAVE_AVX512
+                    case AVX512: return true;
+#endif
+                    default: return false;
+                    }
+                }
+
+                bool cpu_supports(Tier t) {
+                    if (t == Scalar)
+                        return true;
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+                    __builtin_cpu_init();
+                    switch (t) {
+                    case SSE2: return __builtin_cpu_supports("sse2");
+                    case AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+                    case AVX512: return __builtin_cpu_supports("avx512f");
+                    default: return false;
+                    }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+                    int leaf1[4], leaf7[4];
+                    __cpuid(leaf1, 1);
+                    __cpuidex(leaf7, 7, 0);
+                    bool osxsave = (leaf1[2] >> 27) & 1;
+                    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+                    bool ymm = (xcr0 & 0x6) == 0x6;
+                    bool zmm = (xcr0 & 0xe6) == 0xe6;
+                    switch (t) {
+                    case SSE2: return (leaf1[3] >> 26) & 1;
+                    case AVX2: return ymm && ((leaf7[1] >> 5) & 1) && ((leaf1[2] >> 12) & 1);
+                    case AVX512: return zmm && ((leaf7[1] >> 16) & 1);
+                    default: return false;
+                    }
+#else
+                    return false;
+#endif
+                }
+
+                Dispatch table(Tier t) {
+                    using D = void (*)(const double *, double *, std::size_t);
+                    using F = void (*)(const float *, float *, std::size_t);
+                    switch (t) {
+#ifdef MATH_HAVE_AVX512
+                    case AVX512: return {tier_names[t], static_cast<D>(exp_avx512), static_cast<F>(exp_avx512)};
+#endif
+#ifdef MATH_HAVE_AVX2
+                    case AVX2: return {tier_names[t], static_cast<D>(exp_avx2), static_cast<F>(exp_avx2)};
+#endif
+#ifdef MATH_HAVE_SSE2
+                    case SSE2: return {tier_names[t], static_cast<D>(exp_sse2), static_cast<F>(exp_sse2)};
+#endif
+                    default: return {tier_names[Scalar], static_cast<D>(exp_scalar), static_cast<F>(exp_scalar)};
+                    }
+                }
+
+                Dispatch resolve() {
+                    int limit = TierCount - 1;
+                    if (const char *forced = std::getenv("CUSTOMMATH_ISA")) {
+                        std::string name(forced);
+                        for (char &c : name)
+                            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                        int found = -1;
+                        for (int t = 0; t < TierCount; ++t)
+                            if (name == tier_names[t])
+                                found = t;
+                        if (found < 0)
+                            std::cerr << "CustomMath: unknown CUSTOMMATH_ISA '" << forced << "', ignored\n";
+                        else
+                            limit = found;
+                    }
+
+                    int best = limit;
+                    while (best > Scalar && !(compiled(Tier(best)) && cpu_supports(Tier(best))))
+                        --best;
+                    if (best != limit && std::getenv("CUSTOMMATH_ISA"))
+                        std::cerr << "CustomMath: " << tier_names[limit] << " is not available, using " << tier_names[best] << "\n";
+                    return table(Tier(best));
+                }
+            }
+
+            const Dispatch &dispatch() {
+                // resolved once, thread-safe since C++11
+                static const Dispatch active = resolve();
+                return active;
+            }
+
+            namespace {
+                // resolve during static initialization so the first batch call does not pay for detection
+                [[maybe_unused]] const Dispatch &resolved_at_load = dispatch();
+            }
+        }
+    }
+}
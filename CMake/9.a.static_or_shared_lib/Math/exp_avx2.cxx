@@ -0,0 +1,82 @@
+#include "exp_kernels.h"
+
+// AVX2 + FMA, 4 doubles or 8 floats per register
+// FMA keeps the range reduction and the polynomial slightly more accurate than SSE2
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace CustomMath {
+    namespace Inner {
+        namespace Kernels {
+            namespace {
+                inline __m256d exp_pd(__m256d x) {
+                    x = _mm256_min_pd(_mm256_set1_pd(max_input), x);
+                    x = _mm256_max_pd(_mm256_set1_pd(min_input), x);
+
+                    const __m256d shift = _mm256_set1_pd(shifter);
+                    __m256d k = _mm256_sub_pd(_mm256_fmadd_pd(x, _mm256_set1_pd(log2e), shift), shift);
+                    __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(ln2_hi), x);
+                    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(ln2_lo), r);
+
+                    __m256d p = _mm256_set1_pd(poly[poly_degree]);
+                    for (int i = poly_degree - 1; i >= 0; --i) {
+                        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(poly[i]));
+                    }
+
+                    __m256d k1 = _mm256_sub_pd(_mm256_fmadd_pd(k, _mm256_set1_pd(0.5), shift), shift);
+                    __m256i b1 = _mm256_castpd_si256(_mm256_add_pd(k1, shift));
+                    __m256i b2 = _mm256_castpd_si256(_mm256_add_pd(_mm256_sub_pd(k, k1), shift));
+                    const __m256i bias = _mm256_set1_epi64x(1023);
+                    __m256d s1 = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(b1, bias), 52));
+                    __m256d s2 = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(b2, bias), 52));
+                    return _mm256_mul_pd(_mm256_mul_pd(p, s1), s2);
+                }
+
+                inline __m256 exp_ps(__m256 x) {
+                    x = _mm256_min_ps(_mm256_set1_ps(max_input_f), x);
+                    x = _mm256_max_ps(_mm256_set1_ps(min_input_f), x);
+
+                    const __m256 shift = _mm256_set1_ps(shifter_f);
+                    __m256 k = _mm256_sub_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(log2e_f), shift), shift);
+                    __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(ln2_hi_f), x);
+                    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(ln2_lo_f), r);
+
+                    __m256 p = _mm256_set1_ps(poly_f[poly_degree_f]);
+                    for (int i = poly_degree_f - 1; i >= 0; --i) {
+                        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(poly_f[i]));
+                    }
+
+                    __m256 k1 = _mm256_sub_ps(_mm256_fmadd_ps(k, _mm256_set1_ps(0.5f), shift), shift);
+                    __m256i b1 = _mm256_castps_si256(_mm256_add_ps(k1, shift));
+                    __m256i b2 = _mm256_castps_si256(_mm256_add_ps(_mm256_sub_ps(k, k1), shift));
+                    const __m256i bias = _mm256_set1_epi32(127);
+                    __m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(b1, bias), 23));
+                    __m256 s2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(b2, bias), 23));
+                    return _mm256_mul_ps(_mm256_mul_ps(p, s1), s2);
+                }
+            }
+
+            void exp_avx2(const double *in, double *out, std::size_t n) {
+                std::size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    _mm256_storeu_pd(out + i, exp_pd(_mm256_loadu_pd(in + i)));
+                }
+                for (; i < n; ++i) {
+                    out[i] = exp_scalar(in[i]);
+                }
+            }
+
+            void exp_avx2(const float *in, float *out, std::size_t n) {
+                std::size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    _mm256_storeu_ps(out + i, exp_ps(_mm256_loadu_ps(in + i)));
+                }
+                for (; i < n; ++i) {
+                    out[i] = exp_scalar(in[i]);
+                }
+            }
+        }
+    }
+}
+
+#endif
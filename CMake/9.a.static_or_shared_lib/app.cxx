@@ -6,5 +6,6 @@
 int main(int argc, char *argv[])
 {
     std::cout << "e^" << argv[1] << " = " << CustomMath::exp(std::stod(argv[1])) << std::endl;
+    std::cout << "Batch exp runs on the " << CustomMath::simd_tier() << " kernels" << std::endl;
     std::cout << "Generated constant is " << CustomMath::print_generated() << std::endl;
 }
\ No newline at end of file
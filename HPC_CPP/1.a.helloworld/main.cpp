@@ -1,7 +1,12 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 #include <omp.h>
+#include <thread_pool.h>
 
 void hello_openmp()
 {
@@ -28,8 +33,146 @@ void hello_openmp()
     }
 }
 
+// fork/join benchmark: what an empty parallel region, a barrier and a small region cost, in the OpenMP runtime
+// and in thread_pool.h, the pool spins and then parks like an OpenMP runtime with OMP_WAIT_POLICY unset
+// run with --bench [--threads <max>] [--repeat <n>]
+// the runtime reads OMP_WAIT_POLICY when it starts, so --bench runs itself again once per policy
+// (unset, active, passive) with --bench-policy, which measures the current policy only
+// results are printed as CSV: wait_policy,runtime,threads,region_us,barrier_us,small_region_us
+//   region_us        entering and leaving an empty parallel region (fork and join)
+//   barrier_us       one barrier inside a running region
+//   small_region_us  a region in which every thread sums 1024 doubles, about a microsecond of work
+namespace forkjoin
+{
+    using clock = std::chrono::steady_clock;
+
+    template <typename F>
+    double microseconds_per_call(F &&f, int repeat)
+    {
+        f(); // warm up: the runtime creates its threads in the first region
+        auto start = clock::now();
+        for (int r = 0; r < repeat; r++)
+        {
+            f();
+        }
+        return std::chrono::duration<double, std::micro>(clock::now() - start).count() / repeat;
+    }
+
+    int measure(int max_threads, int repeat)
+    {
+        const char *policy = std::getenv("OMP_WAIT_POLICY");
+        const std::string policy_name = policy ? policy : "unset";
+        std::vector<double> data(1024 * static_cast<std::size_t>(max_threads), 1.0);
+        std::vector<double> sums(max_threads);
+
+        for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+        {
+            // the region body sums a slice, so that a region is not only synchronization
+            auto slice = [&](int t) {
+                double s = 0;
+                const std::size_t begin = 1024 * static_cast<std::size_t>(t);
+                for (std::size_t i = begin; i < begin + 1024; i++)
+                {
+                    s += data[i];
+                }
+                sums[t] = s;
+            };
+
+            // the store keeps the compiler from dropping the region
+            double omp_region = microseconds_per_call([&] {
+#pragma omp parallel num_threads(threads)
+                sums[omp_get_thread_num()] = 0;
+            }, repeat);
+            double omp_barrier = 0;
+#pragma omp parallel num_threads(threads)
+            {
+                auto start = clock::now();
+                for (int r = 0; r < repeat; r++)
+                {
+#pragma omp barrier
+                }
+#pragma omp master
+                omp_barrier = std::chrono::duration<double, std::micro>(clock::now() - start).count() / repeat;
+            }
+            double omp_small = microseconds_per_call([&] {
+#pragma omp parallel num_threads(threads)
+                slice(omp_get_thread_num());
+            }, repeat);
+            std::cout << policy_name << ",openmp," << threads << "," << omp_region << "," << omp_barrier << "," << omp_small << "\n";
+
+            thread_pool pool(threads);
+            double pool_region = microseconds_per_call([&] { pool.run([&](int t) { sums[t] = 0; }); }, repeat);
+            double pool_barrier = 0;
+            pool.run([&](int t) {
+                auto start = clock::now();
+                for (int r = 0; r < repeat; r++)
+                {
+                    pool.barrier();
+                }
+                if (t == 0)
+                    pool_barrier = std::chrono::duration<double, std::micro>(clock::now() - start).count() / repeat;
+            });
+            double pool_small = microseconds_per_call([&] { pool.run(slice); }, repeat);
+            std::cout << policy_name << ",pool," << threads << "," << pool_region << "," << pool_barrier << "," << pool_small << "\n";
+
+            if (threads == max_threads)
+                break;
+        }
+        return 0;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = omp_get_max_threads();
+        int repeat = 10000;
+        bool child = false;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if (flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else if (flag == "--bench-policy")
+                child = true;
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        max_threads = std::max(max_threads, 1);
+        if (child)
+            return measure(max_threads, repeat);
+
+        std::cout << "wait_policy,runtime,threads,region_us,barrier_us,small_region_us" << std::endl;
+        const std::string command = std::string("\"") + argv[0] + "\" --bench --bench-policy --threads " +
+                                    std::to_string(max_threads) + " --repeat " + std::to_string(repeat);
+        int failed = 0;
+        for (const char *policy : {"", "active", "passive"})
+        {
+            // the child inherits the environment, an empty policy runs it with the variable removed
+#if defined(_WIN32)
+            _putenv_s("OMP_WAIT_POLICY", policy);
+#else
+            if (*policy)
+                setenv("OMP_WAIT_POLICY", policy, 1);
+            else
+                unsetenv("OMP_WAIT_POLICY");
+#endif
+            failed += std::system(command.c_str()) != 0;
+        }
+        return failed ? 1 : 0;
+    }
+}
+
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        return forkjoin::benchmark(argc, argv);
+    }
+
     hello_openmp();
     std::getchar();
     return 0;
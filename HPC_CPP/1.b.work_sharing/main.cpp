@@ -1,18 +1,540 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <omp.h>
+#include <string>
+#include <thread>
 #include <vector>
+#include <first_touch.h>
+#include <perf_scope.h>
+#include <pinning.h>
+#include <roofline.h>
 
 void ompfor()
 {
-    std::vector<int> a(1024);
-#pragma omp parallel for
+    // every thread writes the elements it later increments, so on a NUMA machine they land on its node
+    // std::vector<int> a(1024) would zero all of them on the master thread first
+    numa_vector<int> a(1024);
+    first_touch(a.data(), a.size(), 0);
+#pragma omp parallel for schedule(static)
     for (size_t i = 0; i < a.size(); ++i)
     {
         ++a[i];
     }
 }
 
+void ompforSimd()
+{
+    // the same loop, with every thread running its block in vector registers, several elements per instruction
+    // simd:static rounds the blocks to whole vectors, aligned says that p starts on a vector boundary,
+    // so the compiler needs no scalar peel loop before the first aligned element
+    numa_vector<int> a(1024);
+    first_touch(a.data(), a.size(), 0);
+    int *p = a.data();
+    const long long n = static_cast<long long>(a.size());
+#pragma omp parallel for simd schedule(simd : static) aligned(p : simd_alignment)
+    for (long long i = 0; i < n; ++i)
+    {
+        ++p[i];
+    }
+}
+
+// vectorization benchmark: one kernel, a degree 8 polynomial per element, in four variants
+//   scalar         one thread, one element per instruction
+//   simd           one thread, omp simd
+//   threads        omp parallel for, one element per instruction
+//   threads+simd   omp parallel for simd
+// the scalar variants are compiled without auto-vectorization, which -O3 would apply to them as well
+// the vector width is the one of the target, SSE2 unless the build passes e.g. -DCMAKE_CXX_FLAGS=-march=native,
+// configure with -DHPC_VECTORIZE_REPORT=ON to see what the compiler made of every loop
+// run with --simd [--threads <n>] [--max-size <n>] [--repeat <n>]
+// sizes are 2^12 (L1) up to --max-size floats in steps of 16, every size is processed until 2^24 elements are done
+// results are printed as CSV: variant,size,threads,seconds,gelems,gflops,pct_roof
+//   seconds   the fastest of --repeat runs over 2^24 elements
+//   gflops    16 per element, 8 multiplies and 8 adds
+//   pct_roof  gflops over the single precision roofline (roofline.h) at 2 flops per byte (16 flops, 8 bytes per
+//             element), empty until 1.e.roofline has measured the machine, sizes that fit the caches may go past 100
+namespace vectorization
+{
+#if defined(__clang__)
+#define SCALAR_FUNCTION
+#define SCALAR_LOOP _Pragma("clang loop vectorize(disable) interleave(disable)")
+#elif defined(__GNUC__)
+#define SCALAR_FUNCTION __attribute__((optimize("no-tree-vectorize")))
+#define SCALAR_LOOP
+#else
+#define SCALAR_FUNCTION
+#define SCALAR_LOOP
+#endif
+
+    const float c[] = {1.0f, -0.5f, 0.25f, -0.125f, 0.0625f, -0.03125f, 0.015625f, -0.0078125f, 0.00390625f};
+
+#pragma omp declare simd
+    inline float poly(float x)
+    {
+        float y = c[8];
+        for (int k = 7; k >= 0; k--)
+        {
+            y = y * x + c[k];
+        }
+        return y;
+    }
+
+    SCALAR_FUNCTION void scalar(const float *x, float *y, long long n)
+    {
+        SCALAR_LOOP
+        for (long long i = 0; i < n; i++)
+        {
+            y[i] = poly(x[i]);
+        }
+    }
+
+    void simd(const float *x, float *y, long long n)
+    {
+#pragma omp simd aligned(x, y : simd_alignment)
+        for (long long i = 0; i < n; i++)
+        {
+            y[i] = poly(x[i]);
+        }
+    }
+
+    SCALAR_FUNCTION void threads(const float *x, float *y, long long n, int count)
+    {
+#pragma omp parallel for schedule(static) num_threads(count)
+        SCALAR_LOOP
+        for (long long i = 0; i < n; i++)
+        {
+            y[i] = poly(x[i]);
+        }
+    }
+
+    void threads_simd(const float *x, float *y, long long n, int count)
+    {
+#pragma omp parallel for simd schedule(simd : static) num_threads(count) aligned(x, y : simd_alignment)
+        for (long long i = 0; i < n; i++)
+        {
+            y[i] = poly(x[i]);
+        }
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int count = omp_get_max_threads();
+        long long max_size = 1LL << 24;
+        int repeat = 5;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                count = std::atoi(argv[++i]);
+            else if (flag == "--max-size" && i + 1 < argc)
+                max_size = std::atoll(argv[++i]);
+            else if (flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+
+        roofline::summary roof;
+        if (!roof.load())
+            std::cerr << "no roofline in " << roofline::default_path() << ", run 1.e.roofline for pct_roof\n";
+
+        const char *variants[] = {"scalar", "simd", "threads", "threads+simd"};
+        const long long total = 1LL << 24;
+        bool ok = true;
+        std::cout << "variant,size,threads,seconds,gelems,gflops,pct_roof\n";
+        for (long long n = 1LL << 12; n <= max_size; n *= 16)
+        {
+            // placed for the threaded variants, the single thread ones read them from wherever they are
+            numa_vector<float> x(n), y(n), reference(n);
+            first_touch(x.data(), x.size(), 0.0f, 0, count);
+            first_touch(y.data(), y.size(), 0.0f, 0, count);
+            for (long long i = 0; i < n; i++)
+            {
+                x[i] = static_cast<float>(i % 1000) / 1000.0f;
+            }
+            scalar(x.data(), reference.data(), n);
+
+            const long long passes = std::max(1LL, total / n);
+            for (int v = 0; v < 4; v++)
+            {
+                double best = 0;
+                for (int r = 0; r < repeat; r++)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    for (long long p = 0; p < passes; p++)
+                    {
+                        switch (v)
+                        {
+                        case 0:
+                            scalar(x.data(), y.data(), n);
+                            break;
+                        case 1:
+                            simd(x.data(), y.data(), n);
+                            break;
+                        case 2:
+                            threads(x.data(), y.data(), n, count);
+                            break;
+                        default:
+                            threads_simd(x.data(), y.data(), n, count);
+                        }
+                    }
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    best = r == 0 || seconds < best ? seconds : best;
+                }
+                const double elements = double(passes) * double(n), gflops = 16 * elements / best / 1e9;
+                const int used = v < 2 ? 1 : count;
+                std::cout << variants[v] << "," << n << "," << used << "," << best << "," << elements / best / 1e9
+                          << "," << gflops << "," << roofline::percent(roof.percent_of_roof(gflops, 2.0, used, roofline::single_precision)) << "\n";
+
+                // the vector code may contract multiply and add into fma, which rounds once instead of twice
+                for (long long i = 0; i < n; i++)
+                {
+                    if (std::abs(y[i] - reference[i]) > 1e-5f * std::abs(reference[i]))
+                    {
+                        std::cerr << variants[v] << " computed another result than scalar at " << i << "\n";
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+        }
+        return ok ? 0 : 1;
+    }
+
+#undef SCALAR_FUNCTION
+#undef SCALAR_LOOP
+}
+
+// scheduling benchmark: loops whose iterations cost the same, more and more, or a random amount,
+// under every schedule and under taskloop, to see which schedule keeps all threads busy until the end
+// run with --bench [--threads <n>] [--max-size <n>] [--chunk <n>]
+// sizes are 10^4, 10^6 and 10^8 iterations up to --max-size, an iteration costs 16 work units on average
+// results are printed as CSV: workload,schedule,size,threads,wall_s,busy_min_s,busy_max_s,imbalance,busy_s
+//   busy      per thread, the time from the start of the loop until the thread ran out of iterations
+//   imbalance the longest busy time over the mean, 1 is perfect balance
+//   busy_s    the busy time of every thread, separated by spaces
+// the perf scope report at exit has the instructions and misses of every thread and schedule (perf_scope.h),
+// dynamic pays for its balance with the instructions of taking every chunk from the shared counter
+namespace scheduling
+{
+    using clock = std::chrono::steady_clock;
+
+    enum class Workload
+    {
+        Uniform, // 16 units each
+        Linear,  // 0 units at the start up to 32 at the end, the last chunks of a static schedule are the longest
+        Random   // 4 units, or 196 for one iteration in 16
+    };
+
+    const char *names[] = {"uniform", "linear", "random"};
+
+    unsigned cost(Workload w, long long i, long long n)
+    {
+        switch (w)
+        {
+        case Workload::Uniform:
+            return 16;
+        case Workload::Linear:
+            return static_cast<unsigned>(32 * i / n);
+        default:
+        {
+            // splitmix64, so that the cost does not depend on which thread runs the iteration
+            std::uint64_t z = static_cast<std::uint64_t>(i) + 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z ^= z >> 31;
+            return z % 16 == 0 ? 196 : 4;
+        }
+        }
+    }
+
+    // one unit is one dependent multiply-add, a few cycles that the compiler cannot skip
+    double body(Workload w, long long i, long long n)
+    {
+        double x = static_cast<double>(i);
+        for (unsigned k = cost(w, i, n); k > 0; k--)
+        {
+            x = x * 0.999999 + 1.0;
+        }
+        return x;
+    }
+
+    struct Run
+    {
+        double wall;
+        std::vector<double> busy;
+        double checksum;
+    };
+
+    // the loop with schedule(runtime), so that omp_set_schedule picks static, dynamic, guided or auto
+    Run loop(Workload w, long long n, int threads, const std::string &label)
+    {
+        Run run{0, std::vector<double>(threads), 0};
+        double checksum = 0;
+        auto start = clock::now();
+#pragma omp parallel num_threads(threads) reduction(+ : checksum)
+        {
+            PerfScope scope(label);
+#pragma omp for schedule(runtime) nowait
+            for (long long i = 0; i < n; i++)
+            {
+                checksum += body(w, i, n);
+            }
+            // nowait: the thread stops the clock as soon as it runs out of iterations, not after the others
+            run.busy[omp_get_thread_num()] = std::chrono::duration<double>(clock::now() - start).count();
+        }
+        run.wall = std::chrono::duration<double>(clock::now() - start).count();
+        run.checksum = checksum;
+        return run;
+    }
+
+    // one thread creates the tasks, idle threads take them from the others, every task is a chunk of iterations
+    Run tasks(Workload w, long long n, int threads, long long chunk, const std::string &label)
+    {
+        Run run{0, std::vector<double>(threads), 0};
+        std::vector<double> sums(threads);
+        auto start = clock::now();
+#pragma omp parallel num_threads(threads)
+        {
+            // the tasks run inside the single, the other threads take them in its implicit barrier
+            PerfScope scope(label);
+#pragma omp single
+            {
+                // one task per chunk rather than grainsize(chunk), so that the clock is read once per chunk
+                const long long chunks = (n + chunk - 1) / chunk;
+#pragma omp taskloop grainsize(1)
+                for (long long c = 0; c < chunks; c++)
+                {
+                    const long long end = std::min(n, (c + 1) * chunk);
+                    double sum = 0;
+                    for (long long i = c * chunk; i < end; i++)
+                    {
+                        sum += body(w, i, n);
+                    }
+                    // the thread may change between tasks, the busy time of a thread is the end of its last task
+                    const int t = omp_get_thread_num();
+                    sums[t] += sum;
+                    run.busy[t] = std::chrono::duration<double>(clock::now() - start).count();
+                }
+            }
+        }
+        run.wall = std::chrono::duration<double>(clock::now() - start).count();
+        for (double s : sums)
+        {
+            run.checksum += s;
+        }
+        return run;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int threads = omp_get_max_threads();
+        long long max_size = 100000000, chunk = 64;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                threads = std::atoi(argv[++i]);
+            else if (flag == "--max-size" && i + 1 < argc)
+                max_size = std::atoll(argv[++i]);
+            else if (flag == "--chunk" && i + 1 < argc)
+                chunk = std::atoll(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+
+        const struct
+        {
+            std::string name;
+            omp_sched_t kind;
+            int chunk; // 0 is the default of the kind
+        } schedules[] = {
+            {"static", omp_sched_static, 0},
+            {"static," + std::to_string(chunk), omp_sched_static, static_cast<int>(chunk)},
+            {"dynamic", omp_sched_dynamic, 0},
+            {"guided", omp_sched_guided, 0},
+            {"auto", omp_sched_auto, 0},
+        };
+
+        bool ok = true;
+        std::cout << "workload,schedule,size,threads,wall_s,busy_min_s,busy_max_s,imbalance,busy_s\n";
+        for (Workload w : {Workload::Uniform, Workload::Linear, Workload::Random})
+        {
+            for (long long n = 10000; n <= max_size; n *= 100)
+            {
+                double reference = 0;
+                for (std::size_t s = 0; s <= std::size(schedules); s++)
+                {
+                    Run run;
+                    std::string schedule;
+                    if (s < std::size(schedules))
+                    {
+                        omp_set_schedule(schedules[s].kind, schedules[s].chunk);
+                        schedule = schedules[s].name;
+                        run = loop(w, n, threads, std::string(names[static_cast<int>(w)]) + " " + schedule);
+                    }
+                    else
+                    {
+                        schedule = "taskloop," + std::to_string(chunk);
+                        run = tasks(w, n, threads, chunk, std::string(names[static_cast<int>(w)]) + " " + schedule);
+                    }
+
+                    double low = *std::min_element(run.busy.begin(), run.busy.end());
+                    double high = *std::max_element(run.busy.begin(), run.busy.end());
+                    double mean = 0;
+                    for (double b : run.busy)
+                    {
+                        mean += b / threads;
+                    }
+                    // "static,64" is quoted, the comma is part of the name
+                    std::cout << names[static_cast<int>(w)] << ",\"" << schedule << "\"," << n << "," << threads << ","
+                              << run.wall << "," << low << "," << high << "," << high / mean << ",";
+                    for (int t = 0; t < threads; t++)
+                    {
+                        std::cout << (t ? " " : "") << run.busy[t];
+                    }
+                    std::cout << "\n";
+
+                    // every schedule sums the same values, only in another order
+                    if (s == 0)
+                        reference = run.checksum;
+                    else if (std::abs(run.checksum - reference) > 1e-9 * std::abs(reference))
+                    {
+                        std::cerr << schedule << " computed another result than static\n";
+                        ok = false;
+                    }
+                }
+            }
+        }
+        return ok ? 0 : 1;
+    }
+}
+
+// placement benchmark: the bandwidth of a parallel triad a = b + s * c over arrays first written by the master
+// thread against arrays first written by the threads of the triad (first_touch.h)
+// run with --bandwidth [--threads <max>] [--size <doubles per array>] [--repeat <n>] [--pin]
+//   --pin  restarts with OMP_PLACES=cores OMP_PROC_BIND=spread unless they are set, threads that move lose their node
+// results are printed as CSV: touch,threads,size,seconds,gbs,pct_bandwidth,pages_per_node
+//   seconds        the fastest of --repeat triads
+//   gbs            24 bytes per element (2 reads, 1 write) over seconds
+//   pct_bandwidth  gbs over the best STREAM bandwidth of as many threads (roofline.h), empty until 1.e.roofline
+//                  has measured the machine
+// on a machine with one NUMA node both placements are the same and only the noise differs
+namespace placement
+{
+    double triad(numa_vector<double> &a, const numa_vector<double> &b, const numa_vector<double> &c, int threads, int repeat)
+    {
+        const long long n = static_cast<long long>(a.size());
+        double best = 0;
+        for (int r = 0; r < repeat; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for schedule(static) num_threads(threads)
+            for (long long i = 0; i < n; i++)
+            {
+                a[i] = b[i] + 3.0 * c[i];
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = r == 0 || seconds < best ? seconds : best;
+        }
+        return best;
+    }
+
+    std::string nodes(const numa_vector<double> &a)
+    {
+        std::vector<std::size_t> pages = pages_per_node(a.data(), a.size() * sizeof(double));
+        if (pages.empty())
+            return "unknown";
+        std::string text;
+        for (std::size_t node = 0; node < pages.size(); node++)
+        {
+            text += (node ? " node" : "node") + std::to_string(node) + ":" + std::to_string(pages[node]);
+        }
+        return text;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = omp_get_max_threads();
+        std::size_t size = std::size_t(1) << 24;
+        int repeat = 10;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--pin")
+                pinning::apply_binding(argv);
+            else if (flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if (flag == "--size" && i + 1 < argc)
+                size = std::strtoull(argv[++i], nullptr, 10);
+            else if (flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+
+        pinning::report_binding(std::cerr, max_threads);
+        if (pinning::numa_nodes() == 1)
+        {
+            std::cerr << "one NUMA node: master and parallel touch place the pages alike\n";
+        }
+
+        roofline::summary roof;
+        if (!roof.load())
+            std::cerr << "no roofline in " << roofline::default_path() << ", run 1.e.roofline for pct_bandwidth\n";
+
+        std::cout << "touch,threads,size,seconds,gbs,pct_bandwidth,pages_per_node\n";
+        for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+        {
+            for (bool parallel : {false, true})
+            {
+                numa_vector<double> a(size), b(size), c(size);
+                if (parallel)
+                {
+                    first_touch(a.data(), size, 0.0, 0, threads);
+                    first_touch(b.data(), size, 1.0, 0, threads);
+                    first_touch(c.data(), size, 2.0, 0, threads);
+                }
+                else
+                {
+                    for (std::size_t i = 0; i < size; i++)
+                    {
+                        a[i] = 0.0;
+                        b[i] = 1.0;
+                        c[i] = 2.0;
+                    }
+                }
+                double seconds = triad(a, b, c, threads, repeat), gbs = 24.0 * size / seconds / 1e9;
+                std::cout << (parallel ? "parallel" : "master") << "," << threads << "," << size << "," << seconds << ","
+                          << gbs << "," << roofline::percent(roof.percent_of_bandwidth(gbs, threads)) << ","
+                          << nodes(a) << "\n";
+                if (a[size / 2] != 7.0)
+                {
+                    std::cerr << "wrong triad result\n";
+                    return 1;
+                }
+            }
+            if (threads == max_threads)
+                break;
+        }
+        return 0;
+    }
+}
+
 void ompsection()
 {
     std::vector<int> a(1024);
@@ -42,6 +564,183 @@ void ompsection()
     std::cout << std::endl;
 }
 
+void ompPipeline()
+{
+    // the task version of ompsection(): the arrays are cut into chunks, and every chunk goes through two stages
+    //   1. fill the chunk and format it into its own string, any thread, any order
+    //   2. append the string to the output, in chunk order
+    // the depend clauses order the tasks: stage 2 of a chunk waits for stage 1 of that chunk, and for stage 2 of the
+    // chunk before it (both write out), nothing else waits, so formatting never queues behind the output
+    std::vector<int> a(1024);
+    std::vector<char> b(1024);
+    const size_t chunk = 128;
+    std::vector<std::string> text(a.size() / chunk);
+    std::string *part = text.data(); // depend clauses take array elements, not vector elements
+    std::string out;
+
+#pragma omp parallel
+#pragma omp single
+    for (size_t k = 0; k < text.size(); ++k)
+    {
+#pragma omp task depend(out : part[k])
+        {
+            for (size_t i = k * chunk; i < (k + 1) * chunk; ++i)
+            {
+                ++a[i];
+                b[i] = i % 26 + 'a';
+                part[k] += std::to_string(a[i]);
+                part[k] += b[i];
+            }
+        }
+#pragma omp task depend(in : part[k]) depend(inout : out)
+        out += part[k];
+    }
+
+    // one write instead of one std::cout per element, which every thread would have to take turns on
+    std::cout << out << std::endl;
+}
+
+// pipeline benchmark: the same chunked pipeline as sections and as tasks
+// stage 0 produces a chunk, the middle stages transform it, the last stage consumes it in chunk order
+// run with --pipeline [--threads <n>] [--size <elements>]
+//   sections  two sections like ompsection(): one thread runs stage 0 and the middle stages, the other consumes,
+//             whatever the number of threads and stages
+//   tasks     one task per stage and chunk, ordered by depend clauses, every thread takes part
+// stages 2, 4 and 8, chunks of 2^10, 2^14 and 2^18 elements
+// results are printed as CSV: version,stages,chunk,threads,size,seconds,melems_per_s
+namespace pipeline
+{
+    // multiply-adds per element and middle stage, enough that a stage is not only memory traffic
+    constexpr int work = 16;
+
+    void produce(double *p, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            p[i] = static_cast<double>(i % 1024) * 1e-3;
+    }
+
+    void transform(double *p, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            double x = p[i];
+            for (int k = 0; k < work; ++k)
+                x = x * 0.999 + 0.001;
+            p[i] = x;
+        }
+    }
+
+    double consume(const double *p, size_t begin, size_t end)
+    {
+        double sum = 0;
+        for (size_t i = begin; i < end; ++i)
+            sum += p[i];
+        return sum;
+    }
+
+    double sections(std::vector<double> &data, int stages, size_t chunk)
+    {
+        double *p = data.data();
+        const size_t n = data.size(), chunks = (n + chunk - 1) / chunk;
+        std::atomic<size_t> produced{0};
+        double checksum = 0;
+#pragma omp parallel sections num_threads(2)
+        {
+#pragma omp section
+            {
+                for (size_t k = 0; k < chunks; ++k)
+                {
+                    const size_t begin = k * chunk, end = std::min(n, begin + chunk);
+                    produce(p, begin, end);
+                    for (int s = 1; s + 1 < stages; ++s)
+                        transform(p, begin, end);
+                    produced.store(k + 1, std::memory_order_release);
+                }
+            }
+#pragma omp section
+            {
+                for (size_t k = 0; k < chunks; ++k)
+                {
+                    while (produced.load(std::memory_order_acquire) <= k)
+                        std::this_thread::yield();
+                    checksum += consume(p, k * chunk, std::min(n, (k + 1) * chunk));
+                }
+            }
+        }
+        return checksum;
+    }
+
+    double tasks(std::vector<double> &data, int stages, size_t chunk, int threads)
+    {
+        double *p = data.data();
+        const size_t n = data.size(), chunks = (n + chunk - 1) / chunk;
+        double checksum = 0;
+#pragma omp parallel num_threads(threads)
+#pragma omp single
+        for (size_t k = 0; k < chunks; ++k)
+        {
+            // the first element stands for the whole chunk in the depend clauses
+            const size_t begin = k * chunk, end = std::min(n, begin + chunk);
+#pragma omp task depend(out : p[begin])
+            produce(p, begin, end);
+            for (int s = 1; s + 1 < stages; ++s)
+            {
+#pragma omp task depend(inout : p[begin])
+                transform(p, begin, end);
+            }
+            // inout on checksum keeps the consumers in chunk order, so the sum is the same on every run
+#pragma omp task depend(in : p[begin]) depend(inout : checksum)
+            checksum += consume(p, begin, end);
+        }
+        return checksum;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int threads = omp_get_max_threads();
+        size_t size = size_t(1) << 24;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                threads = std::atoi(argv[++i]);
+            else if (flag == "--size" && i + 1 < argc)
+                size = std::strtoull(argv[++i], nullptr, 10);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+
+        std::vector<double> data(size);
+        bool ok = true;
+        std::cout << "version,stages,chunk,threads,size,seconds,melems_per_s\n";
+        for (int stages : {2, 4, 8})
+        {
+            for (size_t chunk : {size_t(1) << 10, size_t(1) << 14, size_t(1) << 18})
+            {
+                double checksums[2];
+                for (int version = 0; version < 2; ++version)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    checksums[version] = version == 0 ? sections(data, stages, chunk) : tasks(data, stages, chunk, threads);
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    std::cout << (version == 0 ? "sections" : "tasks") << "," << stages << "," << chunk << ","
+                              << (version == 0 ? 2 : threads) << "," << size << "," << seconds << "," << size / seconds / 1e6
+                              << "\n";
+                }
+                if (checksums[0] != checksums[1])
+                {
+                    std::cerr << "sections and tasks disagree for " << stages << " stages, chunk " << chunk << "\n";
+                    ok = false;
+                }
+            }
+        }
+        return ok ? 0 : 1;
+    }
+}
+
 void ompsingle()
 {
 #pragma omp parallel
@@ -65,8 +764,27 @@ void ompsingle()
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        return scheduling::benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bandwidth")
+    {
+        return placement::benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--pipeline")
+    {
+        return pipeline::benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--simd")
+    {
+        return vectorization::benchmark(argc, argv);
+    }
+
     ompfor();
+    ompforSimd();
     ompsection();
+    ompPipeline();
     ompsingle();
 
     std::getchar();
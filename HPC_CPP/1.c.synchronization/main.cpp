@@ -1,7 +1,19 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
 #include <omp.h>
+#include <string>
+#include <thread>
 #include <vector>
+#include <per_thread.h>
+#include <bounded_queue.h>
+#include <sync.h>
+#include <first_touch.h>
+#include <histogram.h>
 
 void atomic()
 {
@@ -25,6 +37,187 @@ void atomic()
 
 }
 
+// contention benchmark: the same count of increments on one shared counter, with each way of making it safe
+// run with --bench [--threads <max>] [--max-increments <n>] [--shards <n>] [--budget <seconds>]
+// threads sweep 1, 2, 4, ... up to --threads (default omp_get_max_threads()), increments 10^3 up to 10^9
+// results are printed as CSV: strategy,threads,increments,seconds,mops,efficiency
+//   mops        million increments per second, over all threads
+//   efficiency  mops / (threads * mops of the same strategy on 1 thread), 1 is perfect scaling
+namespace contention
+{
+    // one counter per cache line, so that neighbouring counters never share a line
+    using Padded = padded<std::atomic<long long>>;
+
+    long long atomic(long long n, int threads)
+    {
+        long long sum = 0;
+#pragma omp parallel for num_threads(threads)
+        for (long long i = 0; i < n; i++)
+        {
+#pragma omp atomic
+            ++sum;
+        }
+        return sum;
+    }
+
+    long long critical(long long n, int threads)
+    {
+        long long sum = 0;
+#pragma omp parallel for num_threads(threads)
+        for (long long i = 0; i < n; i++)
+        {
+#pragma omp critical
+            ++sum;
+        }
+        return sum;
+    }
+
+    // the private copies live in registers, and a loop of plain ++sum would fold into a single addition
+    // the increment is read from a volatile on every iteration, so the loop keeps one load and one add per increment
+    long long reduction(long long n, int threads)
+    {
+        volatile long long one = 1;
+        long long sum = 0;
+#pragma omp parallel for num_threads(threads) reduction(+ : sum)
+        for (long long i = 0; i < n; i++)
+        {
+            sum += one;
+        }
+        return sum;
+    }
+
+    // every thread owns one padded counter and merges at the end
+    // the counter is a relaxed atomic so that every increment is a store other threads could read,
+    // like a statistics counter that is sampled while the work runs
+    long long per_thread(long long n, int threads)
+    {
+        std::vector<Padded> counters(threads);
+#pragma omp parallel num_threads(threads)
+        {
+            std::atomic<long long> &mine = counters[omp_get_thread_num()].value;
+#pragma omp for
+            for (long long i = 0; i < n; i++)
+            {
+                mine.store(mine.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+        long long sum = 0;
+        for (const Padded &c : counters)
+        {
+            sum += c.value.load();
+        }
+        return sum;
+    }
+
+    // fewer counters than threads, for when a thread cannot own a counter (e.g. more threads than memory allows)
+    // threads sharing a shard still contend, but only with threads / shards others
+    int shards = 8;
+
+    long long sharded(long long n, int threads)
+    {
+        std::vector<Padded> counters(shards);
+#pragma omp parallel num_threads(threads)
+        {
+            std::atomic<long long> &mine = counters[omp_get_thread_num() % shards].value;
+#pragma omp for
+            for (long long i = 0; i < n; i++)
+            {
+                mine.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        long long sum = 0;
+        for (const Padded &c : counters)
+        {
+            sum += c.value.load();
+        }
+        return sum;
+    }
+
+    struct Strategy
+    {
+        const char *name;
+        long long (*count)(long long, int);
+    };
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = omp_get_max_threads();
+        long long max_increments = 1000000000;
+        double budget = 1.0;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if (flag == "--max-increments" && i + 1 < argc)
+                max_increments = std::atoll(argv[++i]);
+            else if (flag == "--shards" && i + 1 < argc)
+                shards = std::atoi(argv[++i]);
+            else if (flag == "--budget" && i + 1 < argc)
+                budget = std::atof(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        max_threads = std::max(max_threads, 1);
+        shards = std::max(shards, 1);
+
+        std::vector<int> thread_counts;
+        for (int t = 1; t < max_threads; t *= 2)
+        {
+            thread_counts.push_back(t);
+        }
+        thread_counts.push_back(max_threads);
+
+        const Strategy strategies[] = {
+            {"atomic", atomic},
+            {"critical", critical},
+            {"reduction", reduction},
+            {"per_thread", per_thread},
+            {"sharded", sharded},
+        };
+
+        bool ok = true;
+        std::cout << "strategy,threads,increments,seconds,mops,efficiency\n";
+        for (const Strategy &s : strategies)
+        {
+            // single thread throughput per increment count, the base of the efficiency
+            std::vector<double> serial;
+            for (int threads : thread_counts)
+            {
+                std::size_t size = 0;
+                for (long long n = 1000; n <= max_increments; n *= 10, size++)
+                {
+                    s.count(n / 100 + 1, threads); // wake the threads up
+                    auto start = std::chrono::steady_clock::now();
+                    long long got = s.count(n, threads);
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+                    double mops = n / elapsed.count() / 1e6;
+                    if (threads == 1)
+                        serial.push_back(mops);
+                    std::cout << s.name << "," << threads << "," << n << "," << elapsed.count() << "," << mops << ",";
+                    // empty when the single thread run stopped at a smaller count
+                    if (size < serial.size())
+                        std::cout << mops / (threads * serial[size]);
+                    std::cout << "\n";
+                    if (got != n)
+                    {
+                        std::cerr << s.name << " counted " << got << " of " << n << " increments\n";
+                        ok = false;
+                    }
+                    // the throughput has settled long before, the larger counts would only take longer
+                    if (elapsed.count() > budget)
+                        break;
+                }
+            }
+        }
+        return ok ? 0 : 1;
+    }
+}
+
 void order() {
     std::cout<<"out of order printing:"<<std::endl;
 #pragma omp parallel for num_threads(16)
@@ -44,19 +237,47 @@ void order() {
 }
 
 void nowait() {
-#pragma omp parallel num_threads(4);
+    // the input thread hands the numbers to the other threads through a lock-free queue as they are typed
+    mpmc_queue<int> numbers(64);
+    std::atomic<bool> input_done{false};
+    auto work = [](int a) {
+        std::cout<<("common workload on thread " + std::to_string(omp_get_thread_num()) + ": " + std::to_string(a) +
+                    " squared is " + std::to_string(a * a) + "\n");
+    };
+#pragma omp parallel num_threads(4)
 {
 #pragma omp single nowait
     {
         int a;
-        std::cout<<"give me a number:\n";
-        std::cin>>a;
-        std::cout<<"the number is "<<a<<"\n";
+        std::cout<<"give me numbers, anything else ends the input:\n";
+        while(std::cin>>a) {
+            // the workers are behind and the queue is full, or there are no workers (the runtime may grant fewer
+            // threads than asked for): the input thread takes a number off the queue itself to make room
+            while(!numbers.try_push(a)) {
+                int b;
+                if(numbers.try_pop(b))
+                    work(b);
+            }
+        }
+        std::cin.clear();
+        std::cin.ignore(1 << 20, '\n');
+        input_done.store(true, std::memory_order_release);
     }
 
-    // note that this part is AFTER the input, but it could complete on other threads before the input completes
-    // this is because those other threads do not WAIT for the single thread handling the input
-    std::cout<<"common workload on thread "<<omp_get_thread_num()<<"\n";
+    // note that this part is AFTER the input, but it could start on other threads before the input completes
+    // this is because those other threads do not WAIT for the single thread handling the input,
+    // they work on every number as soon as it arrives, and the input thread joins them when the input ends
+    for(;;) {
+        // read the flag before trying the queue, a number pushed before the flag is then always seen
+        bool last = input_done.load(std::memory_order_acquire);
+        int a;
+        if(numbers.try_pop(a))
+            work(a);
+        else if(last)
+            break;
+        else
+            std::this_thread::yield();
+    }
 #pragma omp barrier
 
     // again, master only runs after barrier, meaning that every thread completed their common workload
@@ -68,8 +289,436 @@ void nowait() {
 }
 }
 
+// queue benchmark: producers hand time-stamped items to consumers through each queue of bounded_queue.h
+// run with --queue [--threads <max>] [--items <n>] [--capacity <n>]
+//   spsc    1 producer, 1 consumer
+//   mpmc    p producers and p consumers, p = 1, 2, 4, ... up to half of --threads
+//   locked  the same pairs with the mutex and condition variable queue
+// the lock-free queues yield when full or empty, the locked queue sleeps
+// results are printed as CSV: queue,producers,consumers,items,seconds,items_per_s,p50_ns,p99_ns
+//   p50_ns, p99_ns  percentiles of the time from push to pop of an item
+namespace handoff
+{
+    using clock = std::chrono::steady_clock;
+
+    struct Item
+    {
+        long long stamp; // clock ticks at the push, -1 tells a consumer to stop
+        long long value;
+    };
+
+    long long now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+    }
+
+    // uniform push and pop for the three queues, the lock-free ones retry after a yield
+    template <typename Queue>
+    void push(Queue &q, const Item &item)
+    {
+        while(!q.try_push(item))
+            std::this_thread::yield();
+    }
+
+    template <typename Queue>
+    void pop(Queue &q, Item &item)
+    {
+        while(!q.try_pop(item))
+            std::this_thread::yield();
+    }
+
+    void push(locked_queue<Item> &q, const Item &item) { q.push(item); }
+    void pop(locked_queue<Item> &q, Item &item) { q.pop(item); }
+
+    struct Result
+    {
+        double seconds;
+        std::vector<long long> latencies;
+        long long sum;
+        int threads; // the team the runtime granted, nothing ran unless it is producers + consumers
+    };
+
+    // threads 0 .. producers - 1 push, the others pop, the last producer to finish pushes one stop item per consumer
+    template <typename Queue>
+    Result run(Queue &q, int producers, int consumers, long long items)
+    {
+        Result result{0, {}, 0, 0};
+        std::vector<std::vector<long long>> latencies(consumers);
+        std::atomic<int> finished{0};
+        long long sum = 0;
+        auto start = clock::now();
+#pragma omp parallel num_threads(producers + consumers) reduction(+ : sum)
+        {
+            const int t = omp_get_thread_num();
+            // with a smaller team (OMP_THREAD_LIMIT, nested regions) the producers would wait for consumers that
+            // do not exist
+#pragma omp single
+            result.threads = omp_get_num_threads();
+            const bool granted = result.threads == producers + consumers;
+            if(granted && t < producers) {
+                for(long long i = t; i < items; i += producers)
+                    push(q, Item{now(), i});
+                if(finished.fetch_add(1) + 1 == producers)
+                    for(int c = 0; c < consumers; c++)
+                        push(q, Item{-1, 0});
+            }
+            else if(granted) {
+                std::vector<long long> &mine = latencies[t - producers];
+                mine.reserve(items / consumers + 1);
+                for(;;) {
+                    Item item{};
+                    pop(q, item);
+                    if(item.stamp < 0)
+                        break;
+                    mine.push_back(now() - item.stamp);
+                    sum += item.value;
+                }
+            }
+        }
+        result.seconds = std::chrono::duration<double>(clock::now() - start).count();
+        for(const std::vector<long long> &l : latencies)
+            result.latencies.insert(result.latencies.end(), l.begin(), l.end());
+        result.sum = sum;
+        return result;
+    }
+
+    long long percentile(std::vector<long long> &values, double p) {
+        if(values.empty())
+            return 0;
+        std::size_t k = static_cast<std::size_t>(p * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + k, values.end());
+        return values[k];
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = omp_get_max_threads();
+        long long items = 1000000;
+        std::size_t capacity = 1024;
+        for(int i = 2; i < argc; i++) {
+            std::string flag = argv[i];
+            if(flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if(flag == "--items" && i + 1 < argc)
+                items = std::atoll(argv[++i]);
+            else if(flag == "--capacity" && i + 1 < argc)
+                capacity = std::strtoull(argv[++i], nullptr, 10);
+            else {
+                std::cerr<<"unknown option "<<flag<<"\n";
+                return 2;
+            }
+        }
+
+        bool ok = true;
+        const long long expected = items * (items - 1) / 2;
+        auto report = [&](const char *name, int producers, int consumers, Result r) {
+            if(r.threads != producers + consumers) {
+                std::cerr<<name<<" with "<<producers<<" producers and "<<consumers<<" consumers skipped, the runtime "
+                         <<"granted "<<r.threads<<" threads\n";
+                ok = false;
+                return;
+            }
+            std::cout<<name<<","<<producers<<","<<consumers<<","<<items<<","<<r.seconds<<","<<items / r.seconds<<","
+                     <<percentile(r.latencies, 0.5)<<","<<percentile(r.latencies, 0.99)<<"\n";
+            if(r.sum != expected || static_cast<long long>(r.latencies.size()) != items) {
+                std::cerr<<name<<" with "<<producers<<" producers lost or duplicated items\n";
+                ok = false;
+            }
+        };
+
+        std::cout<<"queue,producers,consumers,items,seconds,items_per_s,p50_ns,p99_ns\n";
+        {
+            spsc_queue<Item> q(capacity);
+            report("spsc", 1, 1, run(q, 1, 1, items));
+        }
+        for(int p = 1; p == 1 || 2 * p <= max_threads; p *= 2) {
+            mpmc_queue<Item> lock_free(capacity);
+            report("mpmc", p, p, run(lock_free, p, p, items));
+            locked_queue<Item> locked(capacity);
+            report("locked", p, p, run(locked, p, p, items));
+        }
+        return ok ? 0 : 1;
+    }
+}
+
+// synchronization benchmark: the barriers and locks of sync.h against #pragma omp barrier, #pragma omp critical
+// and omp_lock_t, at 1, 2, 4, ... threads up to --threads (default: every hardware thread)
+// run with --sync [--threads <max>] [--episodes <n>] [--acquisitions <n>]
+//   barriers  every thread passes --episodes barriers, and checks after each that its neighbour arrived
+//   locks     the threads share --acquisitions increments of one counter, each under the lock
+// results are printed as CSV: kind,implementation,threads,operations,seconds,ns_per_op
+//   ns_per_op  barriers: the time of one episode, locks: the time per acquisition over all threads, which is
+//              the hand-over time from one holder to the next once the lock is contended
+// spinning threads yield after a while (spin_wait), the numbers beyond the hardware threads measure the scheduler
+namespace primitives
+{
+    using clock = std::chrono::steady_clock;
+
+    template <typename Wait>
+    double barrier_time(Wait wait, int threads, long long episodes, bool &ok)
+    {
+        per_thread<std::atomic<long long>> arrived(threads);
+        double seconds = 0;
+        bool broken = false;
+#pragma omp parallel num_threads(threads) reduction(|| : broken)
+        {
+            const int t = omp_get_thread_num();
+            std::atomic<long long> &mine = arrived[t];
+            const std::atomic<long long> &next = arrived[(t + 1) % threads];
+#pragma omp barrier
+            auto start = clock::now();
+            for (long long e = 1; e <= episodes; e++)
+            {
+                mine.store(e, std::memory_order_relaxed);
+                wait(t);
+                // the barrier orders the neighbour's store before this load
+                broken = broken || next.load(std::memory_order_relaxed) < e;
+            }
+#pragma omp barrier
+            if (t == 0)
+                seconds = std::chrono::duration<double>(clock::now() - start).count();
+            broken = broken || omp_get_num_threads() != threads;
+        }
+        ok = ok && !broken;
+        return seconds;
+    }
+
+    // guarded(f) runs f under the lock
+    template <typename Guarded>
+    double lock_time(Guarded guarded, int threads, long long acquisitions, bool &ok)
+    {
+        long long counter = 0;
+        double seconds = 0;
+#pragma omp parallel num_threads(threads)
+        {
+#pragma omp barrier
+            auto start = clock::now();
+#pragma omp for schedule(static) nowait
+            for (long long i = 0; i < acquisitions; i++)
+            {
+                guarded([&] { ++counter; });
+            }
+#pragma omp barrier
+            if (omp_get_thread_num() == 0)
+                seconds = std::chrono::duration<double>(clock::now() - start).count();
+        }
+        ok = ok && counter == acquisitions;
+        return seconds;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+        long long episodes = 100000, acquisitions = 1000000;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if (flag == "--episodes" && i + 1 < argc)
+                episodes = std::atoll(argv[++i]);
+            else if (flag == "--acquisitions" && i + 1 < argc)
+                acquisitions = std::atoll(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        max_threads = std::max(max_threads, 1);
+
+        bool ok = true;
+        auto report = [](const char *kind, const char *name, int threads, long long operations, double seconds) {
+            std::cout << kind << "," << name << "," << threads << "," << operations << "," << seconds << ","
+                      << seconds / double(operations) * 1e9 << "\n";
+        };
+        std::cout << "kind,implementation,threads,operations,seconds,ns_per_op\n";
+        for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+        {
+            report("barrier", "omp", threads, episodes, barrier_time([](int) {
+#pragma omp barrier
+            }, threads, episodes, ok));
+            sense_barrier sense(threads);
+            report("barrier", "sense", threads, episodes,
+                   barrier_time([&](int t) { sense.wait(t); }, threads, episodes, ok));
+            dissemination_barrier dissemination(threads);
+            report("barrier", "dissemination", threads, episodes,
+                   barrier_time([&](int t) { dissemination.wait(t); }, threads, episodes, ok));
+            tournament_barrier tournament(threads);
+            report("barrier", "tournament", threads, episodes,
+                   barrier_time([&](int t) { tournament.wait(t); }, threads, episodes, ok));
+
+            report("lock", "omp_critical", threads, acquisitions, lock_time([](auto f) {
+#pragma omp critical(primitives)
+                f();
+            }, threads, acquisitions, ok));
+            omp_lock_t omp_lock;
+            omp_init_lock(&omp_lock);
+            report("lock", "omp_lock", threads, acquisitions, lock_time([&](auto f) {
+                omp_set_lock(&omp_lock);
+                f();
+                omp_unset_lock(&omp_lock);
+            }, threads, acquisitions, ok));
+            omp_destroy_lock(&omp_lock);
+            ttas_lock ttas;
+            report("lock", "ttas", threads, acquisitions, lock_time([&](auto f) {
+                std::lock_guard<ttas_lock> guard(ttas);
+                f();
+            }, threads, acquisitions, ok));
+            ticket_lock ticket;
+            report("lock", "ticket", threads, acquisitions, lock_time([&](auto f) {
+                std::lock_guard<ticket_lock> guard(ticket);
+                f();
+            }, threads, acquisitions, ok));
+            mcs_lock mcs;
+            report("lock", "mcs", threads, acquisitions, lock_time([&](auto f) {
+                mcs_lock::guard guard(mcs);
+                f();
+            }, threads, acquisitions, ok));
+
+            if (threads == max_threads)
+                break;
+        }
+        if (!ok)
+            std::cerr << "a barrier let a thread through early or a lock lost an increment\n";
+        return ok ? 0 : 1;
+    }
+}
+
+// histogram benchmark: counts[key[i]]++ over random keys, the scatter update of histograms and group counts,
+// with each strategy of histogram.h
+// run with --histogram [--threads <max>] [--size <n>] [--max-bins <n>] [--repeat <n>]
+// bins 16, 256, 4096, ... up to --max-bins (default 10^7), --size keys (default 2^25), threads sweep 1, 2, 4, ...
+// keys are uniform over the bins, or hot: half of them fall on the first 16 bins, like a skewed group-by
+// results are printed as CSV: strategy,chosen,distribution,bins,threads,seconds,mupdates,overhead_bytes
+//   chosen          the strategy hybrid took, the strategy itself otherwise
+//   mupdates        million updates per second, over all threads, the fastest of --repeat runs
+//   overhead_bytes  memory allocated on top of the shared bins, the private copies of privatized
+namespace scatter
+{
+    using Count = unsigned;
+
+    // a fixed pseudo-random key per index (splitmix64), so that every run and thread count sees the same keys
+    std::uint64_t mix(std::uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = omp_get_max_threads();
+        std::size_t size = std::size_t(1) << 25, max_bins = 10000000;
+        int repeat = 3;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if (flag == "--size" && i + 1 < argc)
+                size = std::strtoull(argv[++i], nullptr, 10);
+            else if (flag == "--max-bins" && i + 1 < argc)
+                max_bins = std::strtoull(argv[++i], nullptr, 10);
+            else if (flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        max_threads = std::max(max_threads, 1);
+
+        std::vector<std::size_t> bin_counts;
+        for (std::size_t bins = 16; bins < max_bins; bins *= 16)
+            bin_counts.push_back(bins);
+        bin_counts.push_back(max_bins);
+
+        bool ok = true;
+        numa_vector<std::uint32_t> keys(size);
+        std::cout << "strategy,chosen,distribution,bins,threads,seconds,mupdates,overhead_bytes\n";
+        for (std::size_t bins : bin_counts)
+        {
+            for (const char *distribution : {"uniform", "hot"})
+            {
+                const bool hot = std::string(distribution) == "hot";
+                const std::size_t hot_bins = std::min<std::size_t>(bins, 16);
+                const long long n = static_cast<long long>(size);
+#pragma omp parallel for schedule(static) num_threads(max_threads)
+                for (long long i = 0; i < n; i++)
+                {
+                    const std::uint64_t r = mix(static_cast<std::uint64_t>(i));
+                    keys[i] = static_cast<std::uint32_t>(hot && (r >> 63) ? (r >> 32) % hot_bins : r % bins);
+                }
+                std::vector<Count> expected(bins);
+                for (std::uint32_t k : keys)
+                    expected[k]++;
+                const std::uint32_t *key = keys.data();
+                auto bin_of = [key](std::size_t i) { return key[i]; };
+
+                for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+                {
+                    auto run = [&](const char *name, auto count) {
+                        numa_vector<Count> counts(bins);
+                        histogram::strategy chosen = histogram::strategy::privatized;
+                        double fastest = 0;
+                        for (int r = 0; r < repeat; r++)
+                        {
+                            first_touch(counts.data(), bins, Count(), 0, threads);
+                            auto start = std::chrono::steady_clock::now();
+                            chosen = count(counts.data());
+                            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                            fastest = r == 0 || seconds < fastest ? seconds : fastest;
+                        }
+                        if (!std::equal(counts.begin(), counts.end(), expected.begin()))
+                        {
+                            std::cerr << name << " miscounted " << bins << " bins on " << threads << " threads\n";
+                            ok = false;
+                        }
+                        std::cout << name << "," << histogram::name(chosen) << "," << distribution << "," << bins << ","
+                                  << threads << "," << fastest << "," << double(size) / fastest / 1e6 << ","
+                                  << histogram::overhead(chosen, bins, threads, sizeof(Count)) << "\n";
+                    };
+                    run("privatized", [&](Count *counts) {
+                        histogram::privatized(size, bin_of, counts, bins, threads);
+                        return histogram::strategy::privatized;
+                    });
+                    run("atomic", [&](Count *counts) {
+                        histogram::atomic(size, bin_of, counts, bins, threads);
+                        return histogram::strategy::atomic;
+                    });
+                    run("hybrid", [&](Count *counts) { return histogram::hybrid(size, bin_of, counts, bins, threads); });
+
+                    if (threads == max_threads)
+                        break;
+                }
+            }
+        }
+        return ok ? 0 : 1;
+    }
+}
+
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        return contention::benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--queue")
+    {
+        return handoff::benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sync")
+    {
+        return primitives::benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--histogram")
+    {
+        return scatter::benchmark(argc, argv);
+    }
+
     atomic();
     order();
     nowait();
@@ -1,7 +1,17 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <execution>
+#include <functional>
+#include <numeric>
 #include <omp.h>
+#include <string>
 #include <vector>
+#include <first_touch.h>
+#include <per_thread.h>
+#include <perf_scope.h>
+#include <scan.h>
 
 void shared() {
     int s = 10;
@@ -13,6 +23,19 @@ void shared() {
     std::cout<<"unreliable shared variable: "<<s<<std::endl;
 }
 
+void perThread() {
+    // the reliable version of shared(): every thread writes its own slot, the slots are combined afterwards
+    per_thread<int> s(4);
+#pragma omp parallel for num_threads(4)
+    for(int i = 0; i < 10; i++) {
+        s.local() += i;
+    }
+
+    std::cout<<"per-thread slots combined: "<<s.sum()<<" (always 45)\n";
+    int highest = s.combine(-1, [](int a, int b) { return a > b ? a : b; });
+    std::cout<<"largest partial sum of one thread: "<<highest<<"\n";
+}
+
 void privateVar() {
     int s = 10;
 #pragma omp parallel for num_threads(4) private(s)
@@ -51,13 +74,237 @@ void lastPrivate() {
     std::cout<<"shared variable relies on the version on the thread that executed the last iteration: "<<s<<"\n";
 }
 
+void prefixSum() {
+    // lastprivate lets the value of the last iteration escape the loop, a scan keeps the running value of every
+    // iteration, s[i] = 10 + a[0] + ... + a[i - 1] before it and a[0] + ... + a[i] after it, in parallel (scan.h)
+    std::vector<int> a(10, 1), s(10);
+    scan::exclusive_scan(a.data(), s.data(), a.size(), 10);
+    std::cout<<"running values before every iteration:";
+    for(int v : s) {
+        std::cout<<" "<<v;
+    }
+    scan::inclusive_scan(a.data(), s.data(), a.size(), [](int x, int y) { return x + y; }, 0);
+    std::cout<<"\nrunning sums after every iteration:";
+    for(int v : s) {
+        std::cout<<" "<<v;
+    }
+    std::cout<<"\n";
+}
+
+// false sharing benchmark: every thread increments its own counter, either packed next to the others' counters
+// or padded to a cache line of its own
+// run with --bench [--threads <max>] [--increments <per thread>]
+// results are printed as CSV: threads,increments,packed_s,padded_s,packed_mops,padded_mops,slowdown
+//   slowdown  packed time over padded time, what sharing cache lines costs
+// every thread does the same work, so without false sharing both times stay flat as threads are added
+// the perf scope report at exit has the counters of every thread (perf_scope.h): false sharing shows as
+// L1 data cache misses on a counter nobody else writes, and as a lower IPC
+namespace sharing {
+    // volatile, so that every increment is a load and a store, like a counter other threads may inspect
+    template <typename Slot>
+    double increment(const char *name, Slot slot, int threads, long long increments) {
+        auto start = std::chrono::steady_clock::now();
+#pragma omp parallel num_threads(threads)
+        {
+            PerfScope scope(std::string(name) + " " + std::to_string(threads) + " threads");
+            volatile long long &mine = slot(omp_get_thread_num());
+            for(long long i = 0; i < increments; i++) {
+                mine = mine + 1;
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int benchmark(int argc, char *argv[]) {
+        int max_threads = omp_get_max_threads();
+        long long increments = 10000000;
+        for(int i = 2; i < argc; i++) {
+            std::string flag = argv[i];
+            if(flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if(flag == "--increments" && i + 1 < argc)
+                increments = std::atoll(argv[++i]);
+            else {
+                std::cerr<<"unknown option "<<flag<<"\n";
+                return 2;
+            }
+        }
+
+        // start the threads once, so that the first measurement does not include creating them
+#pragma omp parallel num_threads(max_threads)
+        {
+        }
+
+        bool ok = true;
+        std::cout<<"threads,increments,packed_s,padded_s,packed_mops,padded_mops,slowdown\n";
+        for(int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+            // 8 counters of 8 bytes share one 64 byte line
+            std::vector<long long> packed(threads);
+            per_thread<long long> padded(threads);
+            double packed_s = increment("packed", [&](int t) -> long long & { return packed[t]; }, threads, increments);
+            double padded_s = increment("padded", [&](int t) -> long long & { return padded[t]; }, threads, increments);
+
+            const double total = double(increments) * threads;
+            std::cout<<threads<<","<<increments<<","<<packed_s<<","<<padded_s<<","<<total / packed_s / 1e6<<","
+                     <<total / padded_s / 1e6<<","<<packed_s / padded_s<<"\n";
+            for(int t = 0; t < threads; t++) {
+                ok = ok && packed[t] == increments;
+            }
+            ok = ok && padded.sum() == total;
+            if(threads == max_threads)
+                break;
+        }
+        if(!ok)
+            std::cerr<<"an increment was lost\n";
+        return ok ? 0 : 1;
+    }
+}
+
+// scan benchmark: prefix sums of long long over first-touched arrays, scan.h against the standard library
+// run with --scan [--threads <n>] [--max-size <n>] [--repeat <n>]
+// sizes are 2^16 up to --max-size (default 2^25) elements in steps of 16
+//   std, std_par        std::inclusive_scan, sequential and with std::execution::par (libstdc++ needs TBB for it,
+//                       without TBB the par policy runs sequentially, see CMakeLists.txt)
+//   directive, blocked  scan::directive_inclusive_scan (when the compiler has the scan directive) and
+//                       scan::blocked_inclusive_scan
+//   *_exclusive         the exclusive scans
+//   *_matrix            a custom operator, products of 2x2 matrices modulo 2^32, associative but not commutative,
+//                       so only the blocked scan takes it
+// results are printed as CSV: implementation,size,threads,seconds,gelems,gbs
+//   seconds  the fastest of --repeat scans, gbs counts one read and one write of every element
+namespace prefix {
+    struct Matrix {
+        unsigned a, b, c, d;
+        bool operator==(const Matrix &o) const { return a == o.a && b == o.b && c == o.c && d == o.d; }
+    };
+
+    struct Multiply {
+        Matrix operator()(const Matrix &x, const Matrix &y) const {
+            return {x.a * y.a + x.b * y.c, x.a * y.b + x.b * y.d, x.c * y.a + x.d * y.c, x.c * y.b + x.d * y.d};
+        }
+    };
+
+    const Matrix unit = {1, 0, 0, 1};
+
+    template <typename Scan>
+    double best(Scan scan, int repeat) {
+        double fastest = 0;
+        for(int r = 0; r < repeat; r++) {
+            auto start = std::chrono::steady_clock::now();
+            scan();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            fastest = r == 0 || seconds < fastest ? seconds : fastest;
+        }
+        return fastest;
+    }
+
+    int benchmark(int argc, char *argv[]) {
+        int threads = omp_get_max_threads();
+        std::size_t max_size = std::size_t(1) << 25;
+        int repeat = 5;
+        for(int i = 2; i < argc; i++) {
+            std::string flag = argv[i];
+            if(flag == "--threads" && i + 1 < argc)
+                threads = std::atoi(argv[++i]);
+            else if(flag == "--max-size" && i + 1 < argc)
+                max_size = std::strtoull(argv[++i], nullptr, 10);
+            else if(flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else {
+                std::cerr<<"unknown option "<<flag<<"\n";
+                return 2;
+            }
+        }
+#if defined(_GLIBCXX_USE_TBB_PAR_BACKEND) && !_GLIBCXX_USE_TBB_PAR_BACKEND
+        std::cerr<<"built without TBB, std_par runs sequentially\n";
+#endif
+#if !SCAN_HAVE_DIRECTIVE
+        std::cerr<<"the compiler has no scan directive, the directive rows are left out\n";
+#endif
+
+        bool ok = true;
+        auto report = [&](const char *name, std::size_t n, int used, double seconds, std::size_t bytes) {
+            std::cout<<name<<","<<n<<","<<used<<","<<seconds<<","<<n / seconds / 1e9<<","
+                     <<2.0 * bytes * n / seconds / 1e9<<"\n";
+        };
+        auto check = [&](const char *name, bool same) {
+            if(!same) {
+                std::cerr<<name<<" computed another result than the sequential scan\n";
+                ok = false;
+            }
+        };
+
+        std::cout<<"implementation,size,threads,seconds,gelems,gbs\n";
+        for(std::size_t n = std::size_t(1) << 16; n <= max_size; n *= 16) {
+            numa_vector<long long> in(n), out(n), expected(n);
+            first_touch(in.data(), n, 0LL, 0, threads);
+            first_touch(out.data(), n, 0LL, 0, threads);
+            for(std::size_t i = 0; i < n; i++) {
+                in[i] = static_cast<long long>(i % 7) - 3;
+            }
+            const long long *x = in.data();
+            long long *y = out.data();
+            const std::size_t bytes = sizeof(long long);
+            std::inclusive_scan(in.begin(), in.end(), expected.begin());
+
+            report("std", n, 1, best([&] { std::inclusive_scan(x, x + n, y); }, repeat), bytes);
+            check("std", out == expected);
+            report("std_par", n, threads, best([&] { std::inclusive_scan(std::execution::par, x, x + n, y); }, repeat), bytes);
+            check("std_par", out == expected);
+#if SCAN_HAVE_DIRECTIVE
+            report("directive", n, scan::threads_for(n, threads),
+                   best([&] { scan::directive_inclusive_scan(x, y, n, std::plus<long long>(), 0LL, threads); }, repeat), bytes);
+            check("directive", out == expected);
+#endif
+            report("blocked", n, scan::threads_for(n, threads),
+                   best([&] { scan::blocked_inclusive_scan(x, y, n, std::plus<long long>(), 0LL, threads); }, repeat), bytes);
+            check("blocked", out == expected);
+
+            std::exclusive_scan(in.begin(), in.end(), expected.begin(), 100LL);
+            report("std_exclusive", n, 1, best([&] { std::exclusive_scan(x, x + n, y, 100LL); }, repeat), bytes);
+            check("std_exclusive", out == expected);
+#if SCAN_HAVE_DIRECTIVE
+            report("directive_exclusive", n, scan::threads_for(n, threads),
+                   best([&] { scan::directive_exclusive_scan(x, y, n, 100LL, std::plus<long long>(), 0LL, threads); }, repeat), bytes);
+            check("directive_exclusive", out == expected);
+#endif
+            report("blocked_exclusive", n, scan::threads_for(n, threads),
+                   best([&] { scan::blocked_exclusive_scan(x, y, n, 100LL, std::plus<long long>(), 0LL, threads); }, repeat), bytes);
+            check("blocked_exclusive", out == expected);
+
+            numa_vector<Matrix> m(n), m_out(n);
+            std::vector<Matrix> m_expected(n);
+            first_touch(m.data(), n, unit, 0, threads);
+            first_touch(m_out.data(), n, unit, 0, threads);
+            for(std::size_t i = 0; i < n; i++) {
+                m[i] = {1, static_cast<unsigned>(i % 5), static_cast<unsigned>(i % 3), 1};
+            }
+            std::inclusive_scan(m.begin(), m.end(), m_expected.begin(), Multiply());
+            report("std_matrix", n, 1, best([&] { std::inclusive_scan(m.begin(), m.end(), m_out.begin(), Multiply()); }, repeat), sizeof(Matrix));
+            check("std_matrix", std::equal(m_out.begin(), m_out.end(), m_expected.begin()));
+            report("blocked_matrix", n, scan::threads_for(n, threads),
+                   best([&] { scan::blocked_inclusive_scan(m.data(), m_out.data(), n, Multiply(), unit, threads); }, repeat), sizeof(Matrix));
+            check("blocked_matrix", std::equal(m_out.begin(), m_out.end(), m_expected.begin()));
+        }
+        return ok ? 0 : 1;
+    }
+}
 
 int main(int argc, char *argv[])
 {
+    if(argc > 1 && std::string(argv[1]) == "--bench") {
+        return sharing::benchmark(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "--scan") {
+        return prefix::benchmark(argc, argv);
+    }
+
     shared();
+    perThread();
     privateVar();
     firstPrivate();
     lastPrivate();
+    prefixSum();
 
     std::getchar();
     return 0;
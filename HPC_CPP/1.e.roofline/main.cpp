@@ -0,0 +1,204 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <omp.h>
+#include <string>
+#include <vector>
+#include <first_touch.h>
+#include <pinning.h>
+#include <roofline.h>
+
+// roofline harness: the bandwidth the memory delivers and the flops the cores do, for 1, 2, 4, ... threads
+// the other benchmarks load the result (roofline.h) and report how close they come to it
+// run with [--threads <max>] [--size <n>] [--repeat <n>] [--iterations <n>] [--output <file>] [--pin]
+// --pin restarts with OMP_PLACES=cores OMP_PROC_BIND=spread unless they are set (pinning.h)
+//   STREAM   copy   a = b              16 bytes per element
+//            scale  a = 3 * b          16 bytes
+//            add    a = b + c          24 bytes
+//            triad  a = b + 3 * c      24 bytes
+//            over --size doubles per array (default 2^25, 256 MB each), far more than the caches hold
+//            the bytes are the ones the kernel names, the cache also reads a before writing it (write allocate),
+//            so the memory moves a third or half more, like the original STREAM this does not count it
+//   flops    every thread runs 32 independent chains of x = x * a + b in registers, 2 flops per element and
+//            iteration, --iterations per thread (default 2^24), in double, and in float with 64 chains (flops_float)
+//            the peak of the instruction set the build targets: SSE2 unless the build passes e.g.
+//            -DCMAKE_CXX_FLAGS=-march=native, which may double it or more (AVX, FMA)
+// every array is first-touched by the threads of the kernel with the kernel's schedule, so on a NUMA machine every
+// thread streams from its own node, and every thread count gets fresh arrays
+// results are printed as CSV: kernel,threads,size,seconds,gbs,gflops
+//   size     elements per array, for flops the chains per thread
+//   seconds  the fastest of --repeat runs
+// the roofline, the best bandwidth of the four kernels and the flops of every thread count, is written to --output
+// (default $HPC_ROOFLINE or roofline.txt) and summed up on stderr
+namespace stream
+{
+    using clock = std::chrono::steady_clock;
+
+    template <typename Kernel>
+    double best(Kernel kernel, int repeat)
+    {
+        double fastest = 0;
+        for (int r = 0; r < repeat; r++)
+        {
+            auto start = clock::now();
+            kernel();
+            double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            fastest = r == 0 || seconds < fastest ? seconds : fastest;
+        }
+        return fastest;
+    }
+
+    void copy(double *a, const double *b, long long n, int threads)
+    {
+#pragma omp parallel for simd schedule(static) num_threads(threads) aligned(a, b : simd_alignment)
+        for (long long i = 0; i < n; i++)
+            a[i] = b[i];
+    }
+
+    void scale(double *a, const double *b, long long n, int threads)
+    {
+#pragma omp parallel for simd schedule(static) num_threads(threads) aligned(a, b : simd_alignment)
+        for (long long i = 0; i < n; i++)
+            a[i] = 3.0 * b[i];
+    }
+
+    void add(double *a, const double *b, const double *c, long long n, int threads)
+    {
+#pragma omp parallel for simd schedule(static) num_threads(threads) aligned(a, b, c : simd_alignment)
+        for (long long i = 0; i < n; i++)
+            a[i] = b[i] + c[i];
+    }
+
+    void triad(double *a, const double *b, const double *c, long long n, int threads)
+    {
+#pragma omp parallel for simd schedule(static) num_threads(threads) aligned(a, b, c : simd_alignment)
+        for (long long i = 0; i < n; i++)
+            a[i] = b[i] + 3.0 * c[i];
+    }
+
+    // enough independent chains to cover the latency of the multiply-add on every vector unit:
+    // 4 cycles, 2 units and 4 doubles per AVX2 register make 32, and twice as many floats fit the same registers
+    template <typename T>
+    constexpr int chains = 256 / sizeof(T);
+
+    // the flops of every thread, the sum of the chains keeps the compiler from dropping the loop
+    template <typename T>
+    double flops(long long iterations, int threads)
+    {
+        double sum = 0;
+#pragma omp parallel num_threads(threads) reduction(+ : sum)
+        {
+            T x[chains<T>];
+            for (int j = 0; j < chains<T>; j++)
+                x[j] = static_cast<T>(omp_get_thread_num() + j);
+            for (long long k = 0; k < iterations; k++)
+            {
+#pragma omp simd
+                for (int j = 0; j < chains<T>; j++)
+                    x[j] = x[j] * T(0.999) + T(0.001);
+            }
+            for (int j = 0; j < chains<T>; j++)
+                sum += x[j];
+        }
+        return sum;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int max_threads = omp_get_max_threads();
+        std::size_t size = std::size_t(1) << 25;
+        int repeat = 10;
+        long long iterations = 1LL << 24;
+        std::string output = roofline::default_path();
+        for (int i = 1; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--pin")
+                pinning::apply_binding(argv);
+            else if (flag == "--threads" && i + 1 < argc)
+                max_threads = std::atoi(argv[++i]);
+            else if (flag == "--size" && i + 1 < argc)
+                size = std::strtoull(argv[++i], nullptr, 10);
+            else if (flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else if (flag == "--iterations" && i + 1 < argc)
+                iterations = std::atoll(argv[++i]);
+            else if (flag == "--output" && i + 1 < argc)
+                output = argv[++i];
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        max_threads = std::max(max_threads, 1);
+        pinning::report_binding(std::cerr, max_threads);
+
+        const long long n = static_cast<long long>(size);
+        roofline::summary roof;
+        bool ok = true;
+        std::cout << "kernel,threads,size,seconds,gbs,gflops\n";
+        for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+        {
+            numa_vector<double> a(size), b(size), c(size);
+            first_touch(a.data(), size, 0.0, 0, threads);
+            first_touch(b.data(), size, 1.0, 0, threads);
+            first_touch(c.data(), size, 2.0, 0, threads);
+            double *pa = a.data(), *pb = b.data(), *pc = c.data();
+
+            roofline::point p;
+            p.threads = threads;
+            auto report = [&](const char *kernel, double seconds, double bytes) {
+                const double gbs = bytes * double(size) / seconds / 1e9;
+                std::cout << kernel << "," << threads << "," << size << "," << seconds << "," << gbs << ",\n";
+                return gbs;
+            };
+            p.copy = report("copy", best([&] { copy(pa, pb, n, threads); }, repeat), 16);
+            p.scale = report("scale", best([&] { scale(pa, pb, n, threads); }, repeat), 16);
+            p.add = report("add", best([&] { add(pa, pb, pc, n, threads); }, repeat), 24);
+            p.triad = report("triad", best([&] { triad(pa, pb, pc, n, threads); }, repeat), 24);
+            // b = 1 and c = 2 throughout, so triad leaves 7 everywhere
+            ok = ok && a[0] == 7.0 && a[size - 1] == 7.0;
+
+            auto peak = [&](const char *kernel, auto run, int lanes) {
+                double sum = 0;
+                const double seconds = best([&] { sum = run(); }, repeat);
+                const double gflops = 2.0 * lanes * double(iterations) * threads / seconds / 1e9;
+                std::cout << kernel << "," << threads << "," << lanes << "," << seconds << ",," << gflops << "\n";
+                ok = ok && sum > 0;
+                return gflops;
+            };
+            p.gflops = peak("flops", [&] { return flops<double>(iterations, threads); }, chains<double>);
+            p.gflops_float = peak("flops_float", [&] { return flops<float>(iterations, threads); }, chains<float>);
+
+            roof.add(p);
+            if (threads == max_threads)
+                break;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "a kernel computed a wrong result\n";
+            return 1;
+        }
+        std::cerr << "\nroofline, written to " << output << "\n"
+                  << "threads  bandwidth_gbs  peak_gflops  peak_gflops_float  ridge_flops_per_byte\n";
+        for (const roofline::point &q : roof.points())
+        {
+            std::cerr << q.threads << "  " << q.bandwidth() << "  " << q.gflops << "  " << q.gflops_float << "  "
+                      << q.gflops / q.bandwidth() << "\n";
+        }
+        if (!roof.save(output))
+        {
+            std::cerr << "cannot write " << output << "\n";
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    return stream::benchmark(argc, argv);
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <omp.h>
+#include <string>
+#include <vector>
+#include <first_touch.h>
+#include <roofline.h>
+#include <stencil.h>
+
+// stencil benchmark: jacobi and red-black Gauss-Seidel sweeps over 2D and 3D grids, naive, tiled and wavefront
+// (stencil.h), to see how blocking keeps the throughput up once the grid no longer fits the last level cache
+// run with [--threads <n>] [--dims 2|3|0] [--max-2d <n>] [--max-3d <n>] [--depth <n>] [--tile-x <n>]
+//          [--tile-y <n>] [--repeat <n>]
+// 2D grids of 256^2, 1024^2, 4096^2 up to --max-2d^2, 3D grids of 32^3, 64^3, ... up to --max-3d^3, --dims 0 for
+// both (default), every grid is swept until 2^27 cells are updated, at least 2 * --depth times
+//   naive      one parallel loop over the rows (planes) per sweep
+//   tiled      tiles of --tile-y rows by --tile-x columns (default 64 by 1024 in 2D, 16 by 256 in 3D)
+//   wavefront  --depth sweeps (default 8) per pass over the grid
+// results are printed as CSV: method,dims,variant,edge,cells,threads,sweeps,seconds,glups,pct_stream
+//   seconds     the fastest of --repeat runs (default 3)
+//   glups       billion lattice (interior cell) updates per second
+//   pct_stream  glups over the bandwidth roof of a sweep that reuses nothing across sweeps (roofline.h), 16 bytes per
+//               update for jacobi (read u, write v), 32 for red_black (two half-sweeps over the grid), empty until
+//               1.e.roofline has measured the machine; wavefront goes past 100 where it reuses the cache
+// every variant is checked against the naive one
+namespace sweeps
+{
+    using clock = std::chrono::steady_clock;
+
+    // the x = 0 face at 1, everything else at 0, the heat flows in from there
+    void initialize(numa_vector<double> &a, const stencil::grid &g, int threads)
+    {
+        first_touch(a.data(), a.size(), 0.0, 0, threads);
+        for (int z = 0; z < g.nz; z++)
+            for (int y = 0; y < g.ny; y++)
+                a[g.index(0, y, z)] = 1.0;
+    }
+
+    int benchmark(int argc, char *argv[])
+    {
+        int threads = omp_get_max_threads(), dims = 0, max_2d = 4096, max_3d = 256, depth = 8, repeat = 3;
+        int tile_x = 0, tile_y = 0;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string flag = argv[i];
+            if (flag == "--threads" && i + 1 < argc)
+                threads = std::atoi(argv[++i]);
+            else if (flag == "--dims" && i + 1 < argc)
+                dims = std::atoi(argv[++i]);
+            else if (flag == "--max-2d" && i + 1 < argc)
+                max_2d = std::atoi(argv[++i]);
+            else if (flag == "--max-3d" && i + 1 < argc)
+                max_3d = std::atoi(argv[++i]);
+            else if (flag == "--depth" && i + 1 < argc)
+                depth = std::atoi(argv[++i]);
+            else if (flag == "--tile-x" && i + 1 < argc)
+                tile_x = std::atoi(argv[++i]);
+            else if (flag == "--tile-y" && i + 1 < argc)
+                tile_y = std::atoi(argv[++i]);
+            else if (flag == "--repeat" && i + 1 < argc)
+                repeat = std::atoi(argv[++i]);
+            else
+            {
+                std::cerr << "unknown option " << flag << "\n";
+                return 2;
+            }
+        }
+        threads = std::max(threads, 1);
+        depth = std::max(depth, 1);
+
+        roofline::summary roof;
+        if (!roof.load())
+            std::cerr << "no roofline in " << roofline::default_path() << ", run 1.e.roofline for pct_stream\n";
+
+        std::vector<stencil::grid> grids;
+        if (dims != 3)
+            for (int n = 256; n <= max_2d; n *= 4)
+                grids.push_back({n, n, 1});
+        if (dims != 2)
+            for (int n = 32; n <= max_3d; n *= 2)
+                grids.push_back({n, n, n});
+
+        bool ok = true;
+        std::cout << "method,dims,variant,edge,cells,threads,sweeps,seconds,glups,pct_stream\n";
+        for (const stencil::grid &g : grids)
+        {
+            const int tx = tile_x > 0 ? tile_x : (g.dims() == 2 ? 1024 : 256);
+            const int ty = tile_y > 0 ? tile_y : (g.dims() == 2 ? 64 : 16);
+            const int sweeps = static_cast<int>(std::max<std::size_t>(2 * depth, (std::size_t(1) << 27) / g.interior()));
+            numa_vector<double> u(g.size()), v(g.size());
+            std::vector<double> reference;
+
+            for (stencil::method m : {stencil::method::jacobi, stencil::method::red_black})
+            {
+                const char *method = m == stencil::method::jacobi ? "jacobi" : "red_black";
+                const double bytes = m == stencil::method::jacobi ? 16.0 : 32.0;
+                for (const char *variant : {"naive", "tiled", "wavefront"})
+                {
+                    const std::string name = variant;
+                    double fastest = 0;
+                    const double *out = nullptr;
+                    for (int r = 0; r < repeat; r++)
+                    {
+                        initialize(u, g, threads);
+                        initialize(v, g, threads);
+                        auto start = clock::now();
+                        if (name == "naive")
+                            out = stencil::naive(m, g, u.data(), v.data(), sweeps, threads);
+                        else if (name == "tiled")
+                            out = stencil::tiled(m, g, u.data(), v.data(), sweeps, ty, tx, threads);
+                        else
+                            out = stencil::wavefront(m, g, u.data(), v.data(), sweeps, depth, threads);
+                        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+                        fastest = r == 0 || seconds < fastest ? seconds : fastest;
+                    }
+
+                    // the variants run the same operations in another order, so only the rounding may differ
+                    if (name == "naive")
+                        reference.assign(out, out + g.size());
+                    else
+                        for (std::size_t i = 0; i < g.size(); i++)
+                            if (std::abs(out[i] - reference[i]) > 1e-12)
+                            {
+                                std::cerr << method << " " << variant << " differs from naive at " << i << "\n";
+                                ok = false;
+                                break;
+                            }
+
+                    const double glups = double(g.interior()) * sweeps / fastest / 1e9;
+                    // the bandwidth the sweep would need without reuse across sweeps
+                    const double pct = roof.percent_of_bandwidth(glups * bytes, threads);
+                    std::cout << method << "," << g.dims() << "," << variant << "," << g.nx << "," << g.size() << ","
+                              << threads << "," << sweeps << "," << fastest << "," << glups << ","
+                              << roofline::percent(pct) << "\n";
+                }
+            }
+        }
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    return sweeps::benchmark(argc, argv);
+}
@@ -0,0 +1,198 @@
+#ifndef bounded_queue_h
+#define bounded_queue_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <per_thread.h>
+
+// bounded queues for handing work items from one thread to another
+//   spsc_queue    one producer and one consumer, lock-free, a load and a store per operation
+//   mpmc_queue    any number of producers and consumers, lock-free, one compare-and-swap per operation
+//   locked_queue  any number of both, a mutex and two condition variables, blocks instead of failing
+// the lock-free queues never block: try_push fails when the queue is full, try_pop when it is empty,
+// and the caller decides whether to retry, yield or do something else
+// capacities are rounded up to a power of two
+
+namespace queue_detail
+{
+    inline std::size_t power_of_two(std::size_t n)
+    {
+        std::size_t p = 2;
+        while (p < n)
+            p *= 2;
+        return p;
+    }
+}
+
+// Lamport's ring buffer: the producer owns tail, the consumer owns head, each reads the other's index only when
+// its cached copy says the queue is full (empty), so in the steady state the two cores do not share a line
+template <typename T>
+class spsc_queue
+{
+public:
+    explicit spsc_queue(std::size_t capacity)
+        : mask_(queue_detail::power_of_two(capacity) - 1), items_(new T[mask_ + 1]) {}
+
+    bool try_push(const T &item)
+    {
+        const std::size_t tail = tail_.value.load(std::memory_order_relaxed);
+        if (tail - head_cache_.value > mask_)
+        {
+            head_cache_.value = head_.value.load(std::memory_order_acquire);
+            if (tail - head_cache_.value > mask_)
+                return false;
+        }
+        items_[tail & mask_] = item;
+        tail_.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &item)
+    {
+        const std::size_t head = head_.value.load(std::memory_order_relaxed);
+        if (head == tail_cache_.value)
+        {
+            tail_cache_.value = tail_.value.load(std::memory_order_acquire);
+            if (head == tail_cache_.value)
+                return false;
+        }
+        item = items_[head & mask_];
+        head_.value.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    const std::size_t mask_;
+    std::unique_ptr<T[]> items_;
+    padded<std::atomic<std::size_t>> head_, tail_;
+    // the consumer's last view of tail, the producer's last view of head
+    padded<std::size_t> tail_cache_, head_cache_;
+};
+
+// Vyukov's bounded queue: every cell carries a sequence number that says whose turn it is
+//   sequence == position        free, a producer claiming position may write it
+//   sequence == position + 1    full, a consumer claiming position may read it
+// producers and consumers claim positions with a compare-and-swap on their own counter
+template <typename T>
+class mpmc_queue
+{
+public:
+    explicit mpmc_queue(std::size_t capacity)
+        : mask_(queue_detail::power_of_two(capacity) - 1), cells_(new Cell[mask_ + 1])
+    {
+        for (std::size_t i = 0; i <= mask_; i++)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(const T &item)
+    {
+        std::size_t position = tail_.value.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[position & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t turn = static_cast<std::ptrdiff_t>(sequence - position);
+            if (turn == 0)
+            {
+                if (tail_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.item = item;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (turn < 0)
+                return false; // the cell still holds the item of the previous round
+            else
+                position = tail_.value.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool try_pop(T &item)
+    {
+        std::size_t position = head_.value.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[position & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t turn = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (turn == 0)
+            {
+                if (head_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    item = cell.item;
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (turn < 0)
+                return false; // nothing written here yet
+            else
+                position = head_.value.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T item;
+    };
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    padded<std::atomic<std::size_t>> head_, tail_;
+};
+
+// the usual queue behind a mutex, for comparison and for consumers that should sleep rather than spin
+// close() wakes every waiting consumer, pop then returns false once the queue is empty
+template <typename T>
+class locked_queue
+{
+public:
+    explicit locked_queue(std::size_t capacity) : capacity_(queue_detail::power_of_two(capacity)) {}
+
+    void push(const T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return items_.size() < capacity_; });
+        items_.push_back(item);
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+        if (items_.empty())
+            return false;
+        item = items_.front();
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+private:
+    const std::size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_full_, not_empty_;
+};
+
+#endif
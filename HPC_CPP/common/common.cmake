@@ -0,0 +1,51 @@
+# shared headers of the HPC_CPP examples, include this file and call target_use_common(<target>)
+
+# cache line size of the build machine, per_thread.h pads every slot to it
+# set CACHE_LINE on the command line when cross-compiling or when the detection is wrong
+if(NOT CACHE_LINE)
+    set(line "")
+    if(CMAKE_CROSSCOMPILING)
+        message(STATUS "cross-compiling, set CACHE_LINE for the target, using 64")
+    elseif(APPLE)
+        execute_process(COMMAND sysctl -n hw.cachelinesize OUTPUT_VARIABLE line OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET)
+    elseif(UNIX)
+        execute_process(COMMAND getconf LEVEL1_DCACHE_LINESIZE OUTPUT_VARIABLE line OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET)
+    endif()
+    # getconf prints 0 or nothing on some kernels and architectures
+    if(NOT line MATCHES "^[1-9][0-9]*$")
+        set(line 64)
+    endif()
+    set(CACHE_LINE ${line} CACHE STRING "Cache line size in bytes, the padding of per-thread data")
+endif()
+message(STATUS "cache line: ${CACHE_LINE} bytes")
+
+set(HPC_COMMON_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# the compiler's report on every loop it vectorized, or did not and why, printed while building
+option(HPC_VECTORIZE_REPORT "Print the vectorization remarks of the compiler for the examples" OFF)
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    set(HPC_VECTORIZE_FLAGS -fopt-info-vec-optimized -fopt-info-vec-missed)
+elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(HPC_VECTORIZE_FLAGS -Rpass=loop-vectorize -Rpass-missed=loop-vectorize -Rpass-analysis=loop-vectorize)
+elseif(CMAKE_CXX_COMPILER_ID STREQUAL "IntelLLVM")
+    set(HPC_VECTORIZE_FLAGS -qopt-report=2 -qopt-report-phase=vec)
+elseif(MSVC)
+    set(HPC_VECTORIZE_FLAGS /Qvec-report:2)
+endif()
+
+# profile the OpenMP regions of every example with the OMPT tool of ompt/, it prints a summary at exit
+option(HPC_OMPT_PROFILE "Link the OMPT profiling tool of common/ompt into the examples" OFF)
+if(HPC_OMPT_PROFILE)
+    include(${HPC_COMMON_DIR}/ompt/ompt.cmake)
+endif()
+
+function(target_use_common target)
+    target_include_directories(${target} PRIVATE ${HPC_COMMON_DIR})
+    target_compile_definitions(${target} PRIVATE CACHE_LINE=${CACHE_LINE})
+    if(HPC_VECTORIZE_REPORT)
+        target_compile_options(${target} PRIVATE ${HPC_VECTORIZE_FLAGS})
+    endif()
+    if(HPC_OMPT_PROFILE)
+        target_use_ompt_profile(${target})
+    endif()
+endfunction()
@@ -0,0 +1,134 @@
+#ifndef first_touch_h
+#define first_touch_h
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// first-touch placement: an operating system with NUMA support puts a page on the node of the thread that
+// writes it first, not of the thread that allocated it
+// a vector initialized by the master thread therefore lives on one node, and every other node reads it remotely
+// numa_vector<T> leaves its pages untouched, first_touch() then writes them from the threads that will use them:
+//   numa_vector<double> a(n);
+//   first_touch(a.data(), n, 0.0);            // schedule(static), like the compute loop
+// #pragma omp parallel for schedule(static)
+//   for (...)
+// both loops must split the iterations the same way: same schedule, same chunk, same number of threads
+
+// alignment of the data of a numa_vector, a full vector register up to AVX-512, for the aligned clause of simd loops
+// mmap hands out whole pages, the fallback asks operator new for it
+constexpr std::size_t simd_alignment = 64;
+
+// elements are default-initialized, so neither the allocation nor the construction writes to the pages
+// the memory comes straight from mmap where it exists, malloc may hand out pages another thread touched before
+template <typename T>
+struct untouched_allocator
+{
+    using value_type = T;
+
+    untouched_allocator() = default;
+    template <typename U>
+    untouched_allocator(const untouched_allocator<U> &) {}
+
+    T *allocate(std::size_t n)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        void *p = mmap(nullptr, n * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+#else
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(simd_alignment)));
+#endif
+    }
+
+    void deallocate(T *p, std::size_t n)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(p, n * sizeof(T));
+#else
+        (void)n;
+        ::operator delete(p, std::align_val_t(simd_alignment));
+#endif
+    }
+
+    // no value: default-initialize, which for int or double writes nothing
+    template <typename U>
+    void construct(U *p) { ::new (static_cast<void *>(p)) U; }
+    template <typename U, typename... Args>
+    void construct(U *p, Args &&...args) { ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+
+    template <typename U>
+    bool operator==(const untouched_allocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const untouched_allocator<U> &) const { return false; }
+};
+
+template <typename T>
+using numa_vector = std::vector<T, untouched_allocator<T>>;
+
+// writes value to every element with the schedule of the compute loop: schedule(static), or schedule(static, chunk)
+// threads: the thread count of the compute loop, 0 for the default
+template <typename T>
+void first_touch(T *data, std::size_t n, const T &value, int chunk = 0, int threads = 0)
+{
+    if (threads <= 0)
+        threads = omp_get_max_threads();
+    const long long count = static_cast<long long>(n);
+    if (chunk > 0)
+    {
+#pragma omp parallel for schedule(static, chunk) num_threads(threads)
+        for (long long i = 0; i < count; i++)
+            data[i] = value;
+    }
+    else
+    {
+#pragma omp parallel for schedule(static) num_threads(threads)
+        for (long long i = 0; i < count; i++)
+            data[i] = value;
+    }
+}
+
+// pages of [data, data + bytes) per NUMA node, index = node, e.g. {512, 0} when everything is on node 0
+// empty where the system cannot tell (anything but Linux)
+inline std::vector<std::size_t> pages_per_node(const void *data, std::size_t bytes)
+{
+    std::vector<std::size_t> nodes;
+#if defined(__linux__) && defined(SYS_move_pages)
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t first = reinterpret_cast<std::size_t>(data) / page * page;
+    const std::size_t count = (reinterpret_cast<std::size_t>(data) + bytes - first + page - 1) / page;
+    std::vector<void *> pages(count);
+    std::vector<int> status(count);
+    for (std::size_t i = 0; i < count; i++)
+        pages[i] = reinterpret_cast<void *>(first + i * page);
+    // move_pages without target nodes only reports where every page is
+    if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0)
+        return nodes;
+    for (int node : status)
+    {
+        if (node < 0)
+            continue; // not touched yet
+        if (static_cast<std::size_t>(node) >= nodes.size())
+            nodes.resize(node + 1);
+        nodes[node]++;
+    }
+#else
+    (void)data;
+    (void)bytes;
+#endif
+    return nodes;
+}
+
+#endif
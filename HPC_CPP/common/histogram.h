@@ -0,0 +1,118 @@
+#ifndef histogram_h
+#define histogram_h
+
+#include <cstddef>
+#include <vector>
+#include <omp.h>
+#include <per_thread.h>
+
+// parallel histograms and group counts: counts[bin_of(i)] += 1 for i in 0 .. n - 1, with bin_of(i) < bins
+// the updates scatter over the bins, so threads may hit the same bin at the same time, three ways to make it safe:
+//   privatized  every thread counts into a private copy of the bins, the copies are summed at the end
+//               no contention at all, but threads * bins more counters, and a merge that reads all of them
+//   atomic      every thread updates the shared bins with #pragma omp atomic
+//               no extra memory, but threads that hit the same cache line take turns, which hurts with few bins
+//   hybrid      privatized where the private copies are cheap, atomic otherwise, see choose()
+// the functions add to counts rather than overwrite them, so a histogram can be built in several calls
+//   std::vector<unsigned> counts(bins);
+//   histogram::hybrid(n, [&](std::size_t i) { return key[i] % bins; }, counts.data(), bins);
+
+namespace histogram
+{
+    enum class strategy
+    {
+        privatized,
+        atomic
+    };
+
+    inline const char *name(strategy s) { return s == strategy::privatized ? "privatized" : "atomic"; }
+
+    // a private copy of the bins up to this size stays in the L2 cache of its thread
+    constexpr std::size_t private_budget = std::size_t(1) << 20;
+
+    // the bytes a strategy allocates on top of the shared bins
+    inline std::size_t overhead(strategy s, std::size_t bins, int threads, std::size_t count_bytes)
+    {
+        if (s == strategy::atomic || threads <= 1)
+            return 0;
+        return static_cast<std::size_t>(threads) * bins * count_bytes;
+    }
+
+    // few bins: the atomics contend and the copies are small, so privatize
+    // many bins: two threads rarely meet on a line, so the atomics cost little more than plain increments, while
+    // the copies fall out of the cache and the merge (threads * bins reads) outgrows the counting (n updates)
+    inline strategy choose(std::size_t n, std::size_t bins, int threads, std::size_t count_bytes)
+    {
+        if (threads <= 1)
+            return strategy::privatized;
+        const bool fits = bins * count_bytes <= private_budget;
+        const bool merge_pays = static_cast<std::size_t>(threads) * bins <= n;
+        return fits && merge_pays ? strategy::privatized : strategy::atomic;
+    }
+
+    template <typename Count, typename Bin>
+    void privatized(std::size_t n, Bin bin_of, Count *counts, std::size_t bins, int threads = 0)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        const long long count = static_cast<long long>(n), bin_count = static_cast<long long>(bins);
+        if (threads == 1)
+        {
+            for (long long i = 0; i < count; i++)
+                counts[bin_of(static_cast<std::size_t>(i))]++;
+            return;
+        }
+        per_thread<std::vector<Count>> copies(threads);
+#pragma omp parallel num_threads(threads)
+        {
+            // allocated and zeroed by the thread that counts into it, so its pages are on that thread's node
+            std::vector<Count> &mine = copies.local();
+            mine.assign(bins, Count());
+#pragma omp for schedule(static)
+            for (long long i = 0; i < count; i++)
+                mine[bin_of(static_cast<std::size_t>(i))]++;
+            // every thread sums a range of bins over all copies
+            const int team = omp_get_num_threads();
+#pragma omp for schedule(static)
+            for (long long b = 0; b < bin_count; b++)
+            {
+                Count sum = counts[b];
+                for (int t = 0; t < team; t++)
+                    sum += copies[t][b];
+                counts[b] = sum;
+            }
+        }
+    }
+
+    template <typename Count, typename Bin>
+    void atomic(std::size_t n, Bin bin_of, Count *counts, std::size_t bins, int threads = 0)
+    {
+        (void)bins;
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        const long long count = static_cast<long long>(n);
+#pragma omp parallel for schedule(static) num_threads(threads)
+        for (long long i = 0; i < count; i++)
+        {
+            Count &bin = counts[bin_of(static_cast<std::size_t>(i))];
+#pragma omp atomic update
+            bin++;
+        }
+    }
+
+    // returns the strategy it took
+    template <typename Count, typename Bin>
+    strategy hybrid(std::size_t n, Bin bin_of, Count *counts, std::size_t bins, int threads = 0)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        const strategy s = choose(n, bins, threads, sizeof(Count));
+        if (s == strategy::privatized)
+            privatized(n, bin_of, counts, bins, threads);
+        else
+            atomic(n, bin_of, counts, bins, threads);
+        return s;
+    }
+}
+
+#endif
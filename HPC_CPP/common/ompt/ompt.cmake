@@ -0,0 +1,49 @@
+# the OMPT profiling tool of ompt_profile.cpp, two ways to use it
+#   as a library the runtime loads:   cmake -S common/ompt -B build, then OMP_TOOL_LIBRARIES=build/libompt_profile.so
+#   linked into an example:           cmake -DHPC_OMPT_PROFILE=ON, see common.cmake
+# OMPT needs a runtime that implements it, LLVM's libomp or Intel's libiomp5, GCC's libgomp calls no tool
+# libomp also implements the GOMP_ entry points that GCC emits, so a GCC build runs on libomp when libomp comes first:
+# target_use_ompt_profile() links it ahead of libgomp, a program built without does the same with
+#   LD_PRELOAD=/usr/lib/llvm-<version>/lib/libomp.so OMP_TOOL_LIBRARIES=build/libompt_profile.so ./Main
+# a GCC build loses one distinction that way: libomp reports the GOMP_barrier of every #pragma omp barrier as a barrier
+# of the implementation, so the tool counts them with the implicit barriers and explicit_barrier_ms stays 0,
+# build with clang (-DCMAKE_CXX_COMPILER=clang++) to see them apart
+
+# omp-tools.h comes with the runtime, for GCC it is only in an LLVM installation
+file(GLOB llvm_includes /usr/lib/llvm-*/lib/clang/*/include /usr/local/opt/libomp/include /opt/homebrew/opt/libomp/include)
+find_path(OMPT_INCLUDE_DIR omp-tools.h HINTS ${OpenMP_CXX_INCLUDE_DIRS} PATHS ${llvm_includes})
+
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    file(GLOB llvm_libs /usr/lib/llvm-*/lib)
+    find_library(OMPT_LIBOMP NAMES omp libomp.so.5 PATHS ${llvm_libs})
+endif()
+
+if(NOT OMPT_INCLUDE_DIR)
+    message(WARNING "omp-tools.h not found, set OMPT_INCLUDE_DIR to build the OMPT profiling tool")
+endif()
+
+set(OMPT_PROFILE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# compiles the tool into target, an executable exports its symbols so that the runtime finds ompt_start_tool
+function(target_use_ompt_profile target)
+    if(NOT OMPT_INCLUDE_DIR)
+        return()
+    endif()
+    target_sources(${target} PRIVATE ${OMPT_PROFILE_DIR}/ompt_profile.cpp)
+    target_include_directories(${target} PRIVATE ${OMPT_INCLUDE_DIR})
+    target_link_libraries(${target} PRIVATE ${CMAKE_DL_LIBS})
+    get_target_property(type ${target} TYPE)
+    if(type STREQUAL "EXECUTABLE")
+        set_target_properties(${target} PROPERTIES ENABLE_EXPORTS ON)
+    endif()
+    if(OMPT_LIBOMP)
+        # first on the link line, ahead of the libgomp of OpenMP::OpenMP_CXX and -fopenmp
+        get_target_property(libraries ${target} LINK_LIBRARIES)
+        if(NOT libraries)
+            set(libraries "")
+        endif()
+        set_property(TARGET ${target} PROPERTY LINK_LIBRARIES ${OMPT_LIBOMP} ${libraries})
+    elseif(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        message(WARNING "${target}: libomp not found, libgomp does not support OMPT tools")
+    endif()
+endfunction()
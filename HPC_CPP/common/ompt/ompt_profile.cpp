@@ -0,0 +1,446 @@
+// an OMPT tool that profiles the parallel regions of a program, see ompt.cmake for the two ways to load it
+//   OMP_TOOL_LIBRARIES=/path/to/libompt_profile.so ./Main
+// it records, with the OMPT callbacks of the runtime:
+//   parallel regions   calls, wall time and requested threads per region (per call site)
+//   barriers           time every thread waits in implicit and explicit barriers, and in taskwait/taskgroup
+//   tasks              explicit tasks created and started per thread
+//   imbalance          busy time (implicit task minus waiting) per thread and region, max / mean over the threads
+//                      the explicit tasks a thread runs while it waits in a barrier count as busy, not as waiting
+// at exit it prints a summary table to stderr, and writes every work and wait interval per thread to a CSV
+//   OMPT_PROFILE_TIMELINE   file of the timeline, ompt_timeline.csv by default, empty for none
+//   OMPT_PROFILE_EVENTS     intervals kept per thread, 100000 by default, the rest is only counted
+// nested parallel regions count towards the outermost one, they get no row of their own
+// explicit barriers are only told apart with a compiler that calls libomp directly (clang, icx): a GCC build on
+// libomp reaches every #pragma omp barrier through GOMP_barrier, which libomp reports as a barrier of its own
+// implementation, so there explicit_barrier_ms stays 0 and those waits are in implicit_barrier_ms
+#include <omp-tools.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+namespace
+{
+    std::uint64_t now()
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    enum class Interval : char
+    {
+        work,
+        implicit_barrier,
+        explicit_barrier,
+        taskwait
+    };
+
+    const char *const interval_names[] = {"work", "implicit_barrier", "explicit_barrier", "taskwait"};
+
+    struct Event
+    {
+        std::uint64_t begin, end;
+        const void *region;
+        Interval kind;
+    };
+
+    // a barrier, taskwait or taskgroup the thread waits in, paused while it runs an explicit task from there
+    struct Wait
+    {
+        const ompt_data_t *task; // the task that waits
+        Interval kind;
+        std::uint64_t begin, waited;
+        bool paused;
+    };
+
+    // everything one thread records, only that thread writes it until the runtime shuts down
+    struct Thread
+    {
+        int id = 0;
+        ompt_thread_t type = ompt_thread_unknown;
+
+        // the implicit task the thread is in, depth > 1 in nested regions
+        int depth = 0;
+        const void *region = nullptr;
+        std::uint64_t task_begin = 0, task_waited = 0;
+        // a task run from a wait may wait itself (taskwait), the innermost wait is last
+        std::vector<Wait> waits;
+
+        std::uint64_t busy = 0, waited[4] = {};
+        std::uint64_t tasks_created = 0, tasks_started = 0, dropped = 0;
+        std::map<const void *, std::uint64_t> region_busy;
+        std::vector<Event> timeline;
+    };
+
+    // one execution of a parallel region, in its parallel data
+    struct Instance
+    {
+        std::uint64_t begin;
+        const void *codeptr; // of the outermost region
+        bool nested;
+    };
+
+    struct Region
+    {
+        std::uint64_t calls = 0, total = 0, max = 0;
+        unsigned threads = 0;
+    };
+
+    // the runtime finalizes the tool after the static objects of the program are destroyed, so the state is never freed
+    struct State
+    {
+        std::mutex mutex; // guards threads and regions
+        std::vector<std::unique_ptr<Thread>> threads;
+        std::map<const void *, Region> regions;
+        std::size_t max_events = 100000;
+        std::uint64_t start_time = 0;
+    };
+
+    State &state = *new State;
+    std::mutex &mutex = state.mutex;
+    std::vector<std::unique_ptr<Thread>> &threads = state.threads;
+    std::map<const void *, Region> &regions = state.regions;
+    std::size_t &max_events = state.max_events;
+    std::uint64_t &start_time = state.start_time;
+
+    thread_local Thread *self = nullptr;
+
+    Thread &current()
+    {
+        if (!self)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.emplace_back(new Thread);
+            self = threads.back().get();
+            self->id = static_cast<int>(threads.size()) - 1;
+        }
+        return *self;
+    }
+
+    void record(Thread &t, Interval kind, std::uint64_t begin, std::uint64_t end)
+    {
+        if (t.timeline.size() < max_events)
+            t.timeline.push_back({begin, end, t.region, kind});
+        else
+            t.dropped++;
+    }
+
+    // callbacks
+
+    void on_thread_begin(ompt_thread_t type, ompt_data_t *thread_data)
+    {
+        Thread &t = current();
+        t.type = type;
+        thread_data->value = static_cast<std::uint64_t>(t.id);
+    }
+
+    void on_parallel_begin(ompt_data_t *, const ompt_frame_t *, ompt_data_t *parallel_data, unsigned int requested,
+                           int, const void *codeptr)
+    {
+        // a nested region runs inside an implicit task of the encountering thread, its team works for that region
+        const Thread &t = current();
+        const bool nested = t.depth > 0;
+        parallel_data->ptr = new Instance{now(), nested ? t.region : codeptr, nested};
+        if (nested)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        Region &r = regions[codeptr];
+        r.threads = std::max(r.threads, requested);
+    }
+
+    void on_parallel_end(ompt_data_t *parallel_data, ompt_data_t *, int, const void *codeptr)
+    {
+        // every thread of the team has begun its implicit task by now, none of them reads the instance any more
+        std::unique_ptr<Instance> instance(static_cast<Instance *>(parallel_data->ptr));
+        if (instance->nested)
+            return;
+        const std::uint64_t elapsed = now() - instance->begin;
+        std::lock_guard<std::mutex> lock(mutex);
+        Region &r = regions[codeptr];
+        r.calls++;
+        r.total += elapsed;
+        r.max = std::max(r.max, elapsed);
+    }
+
+    void on_implicit_task(ompt_scope_endpoint_t endpoint, ompt_data_t *parallel_data, ompt_data_t *, unsigned int,
+                          unsigned int, int flags)
+    {
+        if (flags & ompt_task_initial)
+            return;
+        Thread &t = current();
+        if (endpoint == ompt_scope_begin)
+        {
+            if (t.depth++ > 0)
+                return;
+            // the call site is only passed to the encountering thread, the team shares its parallel data
+            t.region = parallel_data && parallel_data->ptr ? static_cast<Instance *>(parallel_data->ptr)->codeptr : nullptr;
+            t.task_begin = now();
+            t.task_waited = 0;
+            return;
+        }
+        if (--t.depth > 0)
+            return;
+        const std::uint64_t end = now();
+        const std::uint64_t busy = end - t.task_begin - std::min(t.task_waited, end - t.task_begin);
+        t.busy += busy;
+        t.region_busy[t.region] += busy;
+        record(t, Interval::work, t.task_begin, end);
+    }
+
+    Interval interval_of(ompt_sync_region_t kind)
+    {
+        switch (kind)
+        {
+        case ompt_sync_region_barrier_explicit:
+            return Interval::explicit_barrier;
+        case ompt_sync_region_taskwait:
+        case ompt_sync_region_taskgroup:
+            return Interval::taskwait;
+        default:
+            // implicit barriers of parallel and worksharing constructs, and the runtime's own, which is where the
+            // explicit barriers of a GCC build end up (see the top of the file)
+            return Interval::implicit_barrier;
+        }
+    }
+
+    // the time since the wait began or resumed, recorded as an interval of its own
+    void wait_until(Thread &t, Wait &w, std::uint64_t end)
+    {
+        w.waited += end - w.begin;
+        record(t, w.kind, w.begin, end);
+    }
+
+    void on_sync_region_wait(ompt_sync_region_t kind, ompt_scope_endpoint_t endpoint, ompt_data_t *, ompt_data_t *task_data,
+                             const void *)
+    {
+        Thread &t = current();
+        if (endpoint == ompt_scope_begin)
+        {
+            t.waits.push_back({task_data, interval_of(kind), now(), 0, false});
+            return;
+        }
+        if (t.waits.empty())
+            return;
+        Wait &w = t.waits.back();
+        if (!w.paused)
+            wait_until(t, w, now());
+        t.waited[static_cast<int>(w.kind)] += w.waited;
+        if (t.depth > 0)
+            t.task_waited += w.waited;
+        t.waits.pop_back();
+    }
+
+    void on_task_create(ompt_data_t *, const ompt_frame_t *, ompt_data_t *new_task_data, int flags, int, const void *)
+    {
+        if (!(flags & ompt_task_explicit))
+            return;
+        current().tasks_created++;
+        new_task_data->value = 1; // not started yet
+    }
+
+    void on_task_schedule(ompt_data_t *prior_task_data, ompt_task_status_t, ompt_data_t *next_task_data)
+    {
+        Thread &t = current();
+        // a task can be scheduled again after it yielded, only its first start counts
+        if (next_task_data && next_task_data->value == 1)
+        {
+            t.tasks_started++;
+            next_task_data->value = 2;
+        }
+        // the runtime runs tasks inside barrier and taskwait waits: the task that waits is switched out while they
+        // run, and switched back in when they complete or yield, the waiting stops and resumes with it
+        if (t.waits.empty())
+            return;
+        Wait &w = t.waits.back();
+        const std::uint64_t time = now();
+        if (!w.paused && prior_task_data == w.task && next_task_data != w.task)
+        {
+            wait_until(t, w, time);
+            w.paused = true;
+        }
+        else if (w.paused && next_task_data == w.task)
+        {
+            w.begin = time;
+            w.paused = false;
+        }
+    }
+
+    // report
+
+    std::string region_name(const void *codeptr)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%p", codeptr);
+        std::string name = buffer;
+#if defined(__GNUC__)
+        // the symbol of the function that holds the construct, exported ones only (-rdynamic for executables),
+        // otherwise the offset in its object file for addr2line
+        Dl_info info;
+        if (codeptr && dladdr(codeptr, &info))
+        {
+            const char *file = info.dli_fname ? std::strrchr(info.dli_fname, '/') : nullptr;
+            file = file ? file + 1 : info.dli_fname;
+            if (info.dli_sname)
+            {
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                name = status == 0 ? demangled : info.dli_sname;
+                std::free(demangled);
+            }
+            else if (file)
+            {
+                std::snprintf(buffer, sizeof(buffer), "+0x%tx",
+                              static_cast<const char *>(codeptr) - static_cast<const char *>(info.dli_fbase));
+                name = std::string(file) + buffer;
+            }
+        }
+#endif
+        return name;
+    }
+
+    double ms(std::uint64_t ns) { return double(ns) * 1e-6; }
+
+    const char *thread_type(ompt_thread_t type)
+    {
+        switch (type)
+        {
+        case ompt_thread_initial:
+            return "initial";
+        case ompt_thread_worker:
+            return "worker";
+        case ompt_thread_other:
+            return "other";
+        default:
+            return "unknown";
+        }
+    }
+
+    void summary(std::FILE *out)
+    {
+        std::fprintf(out, "\nompt profile: %.3f ms, %zu threads, %zu parallel regions\n", ms(now() - start_time),
+                     threads.size(), regions.size());
+
+        std::fprintf(out, "%8s %8s %12s %12s %12s %10s  %s\n", "calls", "threads", "total_ms", "mean_us", "max_us",
+                     "imbalance", "region");
+        for (const auto &entry : regions)
+        {
+            const Region &r = entry.second;
+            if (!r.calls)
+                continue;
+            // max over mean of the busy time of the threads that ran the region
+            std::uint64_t max_busy = 0, sum_busy = 0, count = 0;
+            for (const auto &t : threads)
+            {
+                auto found = t->region_busy.find(entry.first);
+                if (found == t->region_busy.end())
+                    continue;
+                max_busy = std::max(max_busy, found->second);
+                sum_busy += found->second;
+                count++;
+            }
+            const double imbalance = sum_busy ? double(max_busy) * double(count) / double(sum_busy) : 1.0;
+            std::fprintf(out, "%8" PRIu64 " %8u %12.3f %12.3f %12.3f %10.2f  %s\n", r.calls, r.threads, ms(r.total),
+                         double(r.total) * 1e-3 / double(r.calls), double(r.max) * 1e-3, imbalance,
+                         region_name(entry.first).c_str());
+        }
+
+        std::fprintf(out, "\n%-6s %-8s %10s %20s %20s %12s %14s %14s\n", "thread", "type", "busy_ms",
+                     "implicit_barrier_ms", "explicit_barrier_ms", "taskwait_ms", "tasks_created", "tasks_started");
+        for (const auto &t : threads)
+            std::fprintf(out, "%-6d %-8s %10.3f %20.3f %20.3f %12.3f %14" PRIu64 " %14" PRIu64 "\n", t->id,
+                         thread_type(t->type), ms(t->busy), ms(t->waited[int(Interval::implicit_barrier)]),
+                         ms(t->waited[int(Interval::explicit_barrier)]), ms(t->waited[int(Interval::taskwait)]),
+                         t->tasks_created, t->tasks_started);
+    }
+
+    void timeline(const char *path)
+    {
+        std::FILE *out = std::fopen(path, "w");
+        if (!out)
+        {
+            std::fprintf(stderr, "ompt profile: cannot write %s\n", path);
+            return;
+        }
+        // times in microseconds since the tool started, a work interval spans the whole implicit task,
+        // the waits inside it are rows of their own, split where the thread ran an explicit task from the wait
+        std::fprintf(out, "thread,kind,region,begin_us,end_us\n");
+        std::uint64_t dropped = 0;
+        for (const auto &t : threads)
+        {
+            for (const Event &e : t->timeline)
+                std::fprintf(out, "%d,%s,\"%s\",%.3f,%.3f\n", t->id, interval_names[int(e.kind)],
+                             region_name(e.region).c_str(), double(e.begin - start_time) * 1e-3,
+                             double(e.end - start_time) * 1e-3);
+            dropped += t->dropped;
+        }
+        std::fclose(out);
+        std::fprintf(stderr, "ompt profile: timeline in %s", path);
+        if (dropped)
+            std::fprintf(stderr, ", %" PRIu64 " intervals over OMPT_PROFILE_EVENTS left out", dropped);
+        std::fprintf(stderr, "\n");
+    }
+
+    // tool interface
+
+    int initialize(ompt_function_lookup_t lookup, int, ompt_data_t *)
+    {
+        start_time = now();
+        if (const char *events = std::getenv("OMPT_PROFILE_EVENTS"))
+            max_events = static_cast<std::size_t>(std::strtoull(events, nullptr, 10));
+
+        auto set_callback = reinterpret_cast<ompt_set_callback_t>(lookup("ompt_set_callback"));
+        if (!set_callback)
+            return 0;
+        struct
+        {
+            ompt_callbacks_t event;
+            ompt_callback_t callback;
+            const char *name;
+        } callbacks[] = {
+            {ompt_callback_thread_begin, reinterpret_cast<ompt_callback_t>(&on_thread_begin), "thread_begin"},
+            {ompt_callback_parallel_begin, reinterpret_cast<ompt_callback_t>(&on_parallel_begin), "parallel_begin"},
+            {ompt_callback_parallel_end, reinterpret_cast<ompt_callback_t>(&on_parallel_end), "parallel_end"},
+            {ompt_callback_implicit_task, reinterpret_cast<ompt_callback_t>(&on_implicit_task), "implicit_task"},
+            {ompt_callback_sync_region_wait, reinterpret_cast<ompt_callback_t>(&on_sync_region_wait), "sync_region_wait"},
+            {ompt_callback_task_create, reinterpret_cast<ompt_callback_t>(&on_task_create), "task_create"},
+            {ompt_callback_task_schedule, reinterpret_cast<ompt_callback_t>(&on_task_schedule), "task_schedule"},
+        };
+        for (const auto &c : callbacks)
+            if (set_callback(c.event, c.callback) < ompt_set_sometimes)
+                std::fprintf(stderr, "ompt profile: the runtime does not report %s\n", c.name);
+        return 1; // keep the tool
+    }
+
+    void finalize(ompt_data_t *)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        summary(stderr);
+        const char *path = std::getenv("OMPT_PROFILE_TIMELINE");
+        if (!path)
+            path = "ompt_timeline.csv";
+        if (*path)
+            timeline(path);
+    }
+}
+
+// the runtime looks this up when it starts, in the program and its libraries, and in OMP_TOOL_LIBRARIES
+extern "C" ompt_start_tool_result_t *ompt_start_tool(unsigned int, const char *runtime_version)
+{
+    static ompt_start_tool_result_t result = {&initialize, &finalize, {0}};
+    std::fprintf(stderr, "ompt profile: attached to %s\n", runtime_version);
+    return &result;
+}
@@ -0,0 +1,62 @@
+#ifndef per_thread_h
+#define per_thread_h
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+// CACHE_LINE comes from common.cmake, which detects it on the build machine
+#ifndef CACHE_LINE
+#define CACHE_LINE 64
+#endif
+
+constexpr std::size_t cache_line = CACHE_LINE;
+
+// a value alone on its cache line(s), so that writing it never invalidates a neighbour's line
+// sizeof(padded<T>) is a multiple of the cache line, an array of them puts every element on its own lines
+template <typename T>
+struct alignas(cache_line) padded
+{
+    T value;
+
+    padded() : value() {}
+    explicit padded(const T &v) : value(v) {}
+};
+
+// one padded slot per thread of a parallel region, written without synchronization and combined afterwards
+// slots are indexed by omp_get_thread_num(), so the region must not use more threads than the slots
+template <typename T>
+class per_thread
+{
+public:
+    explicit per_thread(int threads = omp_get_max_threads()) : slots_(threads) {}
+    per_thread(int threads, const T &init) : slots_(threads, padded<T>(init)) {}
+
+    // the slot of the calling thread
+    T &local() { return slots_[omp_get_thread_num()].value; }
+
+    T &operator[](int thread) { return slots_[thread].value; }
+    const T &operator[](int thread) const { return slots_[thread].value; }
+
+    int size() const { return static_cast<int>(slots_.size()); }
+
+    // folds the slots in thread order, call it after the region, op(accumulated, slot) returns the new accumulated
+    template <typename Op>
+    T combine(T init, Op op) const
+    {
+        for (const padded<T> &slot : slots_)
+        {
+            init = op(std::move(init), slot.value);
+        }
+        return init;
+    }
+
+    T sum() const { return combine(T(), std::plus<T>()); }
+
+private:
+    std::vector<padded<T>> slots_;
+};
+
+#endif
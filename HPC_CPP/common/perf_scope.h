@@ -0,0 +1,305 @@
+#ifndef perf_scope_h
+#define perf_scope_h
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// hardware counters around a region, per region name and per thread, reported at exit on stderr
+//   {
+//       PerfScope scope("packed");   // on every thread that runs the region
+//       ...
+//   }
+// every thread counts its own events with perf_event_open (Linux), user space only, so the counters work with the
+// default perf_event_paranoid of 2: cycles, instructions, last level cache misses, L1 data cache read misses and
+// branch misses, IPC is instructions over cycles
+// where the counters cannot be opened (no PMU in a VM or container, seccomp, other systems) the report only has
+// the calls and the time, and says why
+// a scope costs two read system calls, a microsecond or two, so it belongs around a loop rather than inside one
+// nested scopes are counted for each of them, the outer one includes the inner one
+
+namespace perf
+{
+    enum event
+    {
+        cycles,
+        instructions,
+        cache_misses,
+        l1d_misses,
+        branch_misses,
+        events
+    };
+
+    struct totals
+    {
+        std::uint64_t calls = 0;
+        double seconds = 0;
+        double counts[events] = {};
+    };
+
+    // one thread's counters and results, owned by the registry so that they outlive the thread
+    class thread_counters
+    {
+    public:
+        struct reading
+        {
+            std::chrono::steady_clock::time_point time;
+            std::uint64_t enabled = 0, running = 0;
+            std::uint64_t values[events] = {};
+        };
+
+        explicit thread_counters(int id) : id_(id) {}
+
+        ~thread_counters()
+        {
+#if defined(__linux__)
+            for (int fd : fds_)
+                close(fd);
+#endif
+        }
+
+        // opens the group of counters on the calling thread, the error of the leader when there is none
+        int open()
+        {
+#if defined(__linux__)
+            const std::uint64_t l1d = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            const struct
+            {
+                std::uint32_t type;
+                std::uint64_t config;
+            } config[events] = {
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                {PERF_TYPE_HW_CACHE, l1d},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            };
+            int leader = -1;
+            for (int e = 0; e < events; e++)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = config[e].type;
+                attr.config = config[e].config;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.disabled = leader < 0; // the group starts with its leader
+                // this thread on any CPU
+                int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+                if (fd < 0)
+                {
+                    if (leader < 0)
+                        return errno;
+                    continue; // the others still count
+                }
+                if (leader < 0)
+                    leader = fd;
+                slot_[e] = static_cast<int>(fds_.size());
+                fds_.push_back(fd);
+            }
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            return 0;
+#else
+            return ENOSYS;
+#endif
+        }
+
+        bool counting() const { return !fds_.empty(); }
+        bool has(event e) const { return slot_[e] >= 0; }
+
+        reading read() const
+        {
+            reading r;
+#if defined(__linux__)
+            if (counting())
+            {
+                // nr, time enabled, time running, then one value per counter in the order they joined the group
+                std::uint64_t buffer[3 + events] = {};
+                if (::read(fds_[0], buffer, sizeof(buffer)) > 0)
+                {
+                    r.enabled = buffer[1];
+                    r.running = buffer[2];
+                    for (int e = 0; e < events; e++)
+                        if (slot_[e] >= 0)
+                            r.values[e] = buffer[3 + slot_[e]];
+                }
+            }
+#endif
+            r.time = std::chrono::steady_clock::now();
+            return r;
+        }
+
+        // adds the events between begin and now to the totals of a region
+        void add(const std::string &name, const reading &begin)
+        {
+            const reading end = read();
+            totals &t = regions_[name];
+            t.calls++;
+            t.seconds += std::chrono::duration<double>(end.time - begin.time).count();
+            // with more events than hardware counters the kernel takes turns, and the counts are extrapolated
+            // from the share of the time they were running
+            const std::uint64_t running = end.running - begin.running;
+            if (running == 0)
+                return;
+            const double scale = double(end.enabled - begin.enabled) / double(running);
+            for (int e = 0; e < events; e++)
+                t.counts[e] += double(end.values[e] - begin.values[e]) * scale;
+        }
+
+        int id() const { return id_; }
+        const std::map<std::string, totals> &regions() const { return regions_; }
+
+    private:
+        int id_;
+        std::vector<int> fds_;
+        int slot_[events] = {-1, -1, -1, -1, -1};
+        std::map<std::string, totals> regions_;
+    };
+
+    // every thread that ran a scope, and the report at exit
+    class registry
+    {
+    public:
+        static registry &instance()
+        {
+            static registry r;
+            return r;
+        }
+
+        thread_counters &local()
+        {
+            thread_local thread_counters *mine = nullptr;
+            if (!mine)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                threads_.emplace_back(new thread_counters(static_cast<int>(threads_.size())));
+                mine = threads_.back().get();
+                int error = mine->open();
+                if (error && !error_)
+                    error_ = error;
+            }
+            return *mine;
+        }
+
+        ~registry() { report(stderr); }
+
+        void report(std::FILE *out)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (threads_.empty())
+                return;
+            bool counted = false;
+            for (const auto &t : threads_)
+                counted = counted || t->counting();
+            if (!counted)
+                std::fprintf(out, "\nperf scope: no hardware counters (perf_event_open: %s), timing only\n",
+                             std::strerror(error_));
+            else if (error_)
+                std::fprintf(out, "\nperf scope: counters missing on some threads (%s)\n", std::strerror(error_));
+
+            // every region summed over all threads (seconds are thread seconds), then per thread where more than
+            // one ran it, threads are numbered in the order they entered their first scope
+            std::map<std::string, std::vector<std::pair<int, totals>>> regions;
+            for (const auto &t : threads_)
+                for (const auto &entry : t->regions())
+                    regions[entry.first].emplace_back(t->id(), entry.second);
+
+            std::fprintf(out, "\n%-32s %6s %10s %12s", "region", "thread", "calls", "seconds");
+            if (counted)
+                std::fprintf(out, " %16s %8s %14s %14s %14s", "instructions", "ipc", "cache_misses", "l1d_misses",
+                             "branch_misses");
+            std::fprintf(out, "\n");
+            for (const auto &region : regions)
+            {
+                totals all;
+                for (const auto &entry : region.second)
+                {
+                    all.calls += entry.second.calls;
+                    all.seconds += entry.second.seconds;
+                    for (int e = 0; e < events; e++)
+                        all.counts[e] += entry.second.counts[e];
+                }
+                row(out, region.first, "all", all, counted);
+                if (region.second.size() > 1)
+                    for (const auto &entry : region.second)
+                        row(out, region.first, std::to_string(entry.first), entry.second, counted);
+            }
+        }
+
+    private:
+        registry() = default;
+
+        // a counter that no thread could open prints as -
+        void row(std::FILE *out, const std::string &name, const std::string &thread, const totals &t, bool counted)
+        {
+            std::fprintf(out, "%-32s %6s %10llu %12.6f", name.c_str(), thread.c_str(),
+                         static_cast<unsigned long long>(t.calls), t.seconds);
+            if (counted)
+            {
+                bool has[events] = {};
+                for (const auto &c : threads_)
+                    for (int e = 0; e < events; e++)
+                        has[e] = has[e] || c->has(static_cast<event>(e));
+                auto count = [&](event e, int width) {
+                    if (has[e])
+                        std::fprintf(out, " %*.0f", width, t.counts[e]);
+                    else
+                        std::fprintf(out, " %*s", width, "-");
+                };
+                count(instructions, 16);
+                if (has[cycles] && has[instructions] && t.counts[cycles] > 0)
+                    std::fprintf(out, " %8.2f", t.counts[instructions] / t.counts[cycles]);
+                else
+                    std::fprintf(out, " %8s", "-");
+                count(cache_misses, 14);
+                count(l1d_misses, 14);
+                count(branch_misses, 14);
+            }
+            std::fprintf(out, "\n");
+        }
+
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<thread_counters>> threads_;
+        int error_ = 0;
+    };
+}
+
+// counts the events of the calling thread from construction to destruction under name
+class PerfScope
+{
+public:
+    explicit PerfScope(std::string name)
+        : name_(std::move(name)), counters_(perf::registry::instance().local()), begin_(counters_.read())
+    {
+    }
+
+    ~PerfScope() { counters_.add(name_, begin_); }
+
+    PerfScope(const PerfScope &) = delete;
+    PerfScope &operator=(const PerfScope &) = delete;
+
+private:
+    std::string name_;
+    perf::thread_counters &counters_;
+    perf::thread_counters::reading begin_;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef pinning_h
+#define pinning_h
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#if defined(__linux__)
+#include <fstream>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// thread pinning of the OpenMP runtime, OMP_PLACES says where threads may run (threads, cores, sockets or a list
+// of CPUs) and OMP_PROC_BIND how they are spread over the places (close, spread, master, true, false)
+// the runtime reads both once when it starts, before main, so a program cannot change them for itself:
+// apply_binding() sets them and restarts the program, report_binding() prints where the threads ended up
+
+namespace pinning
+{
+    // number of NUMA nodes, 1 where the system does not tell
+    inline int numa_nodes()
+    {
+        int nodes = 0;
+#if defined(__linux__)
+        while (std::ifstream("/sys/devices/system/node/node" + std::to_string(nodes) + "/cpulist"))
+            nodes++;
+#endif
+        return nodes > 0 ? nodes : 1;
+    }
+
+    // NUMA node of a CPU, -1 when unknown
+    inline int node_of_cpu(int cpu)
+    {
+#if defined(__linux__)
+        for (int node = 0, nodes = numa_nodes(); node < nodes && cpu >= 0; node++)
+            if (std::ifstream("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node" + std::to_string(node)))
+                return node;
+#else
+        (void)cpu;
+#endif
+        return -1;
+    }
+
+    // CPU the calling thread runs on, -1 when unknown
+    inline int current_cpu()
+    {
+#if defined(__linux__)
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+    // sets OMP_PLACES and OMP_PROC_BIND where the user did not, and runs the program again with them
+    // returns only when nothing had to change, or when the program cannot be restarted (then threads stay unpinned)
+    inline void apply_binding(char *argv[], const char *places = "cores", const char *bind = "spread")
+    {
+        if (std::getenv("OMP_PLACES") && std::getenv("OMP_PROC_BIND"))
+            return;
+#if defined(__linux__)
+        setenv("OMP_PLACES", places, 0);
+        setenv("OMP_PROC_BIND", bind, 0);
+        execv("/proc/self/exe", argv);
+#else
+        (void)argv;
+#endif
+        std::cerr << "cannot restart with OMP_PLACES=" << places << " OMP_PROC_BIND=" << bind
+                  << ", set them before starting the program\n";
+    }
+
+    inline const char *bind_name(omp_proc_bind_t bind)
+    {
+        switch (bind)
+        {
+        case omp_proc_bind_false: return "false";
+        case omp_proc_bind_true: return "true";
+        case omp_proc_bind_master: return "master";
+        case omp_proc_bind_close: return "close";
+        case omp_proc_bind_spread: return "spread";
+        default: return "unknown";
+        }
+    }
+
+    // the binding settings, then thread, place, CPU and NUMA node of every thread of a region with threads threads
+    inline void report_binding(std::ostream &out, int threads = 0)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        const char *places = std::getenv("OMP_PLACES");
+        const char *bind = std::getenv("OMP_PROC_BIND");
+        out << "OMP_PLACES=" << (places ? places : "(unset)") << " OMP_PROC_BIND=" << (bind ? bind : "(unset)")
+            << ": binding " << bind_name(omp_get_proc_bind()) << ", " << omp_get_num_places() << " places, "
+            << numa_nodes() << " NUMA nodes\n";
+
+        std::vector<int> place(threads), cpu(threads);
+#pragma omp parallel num_threads(threads)
+        {
+            const int t = omp_get_thread_num();
+            place[t] = omp_get_place_num();
+            cpu[t] = current_cpu();
+        }
+        for (int t = 0; t < threads; t++)
+            out << "  thread " << t << ": place " << place[t] << ", cpu " << cpu[t] << ", node " << node_of_cpu(cpu[t]) << "\n";
+    }
+}
+
+#endif
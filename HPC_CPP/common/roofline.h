@@ -0,0 +1,142 @@
+#ifndef roofline_h
+#define roofline_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// the roofline of the machine, measured by 1.e.roofline and loaded by the other benchmarks to put their results
+// next to what the hardware can do
+// a kernel that does f flops per byte it moves (its arithmetic intensity) runs at most at
+//   min(peak gflops, f * bandwidth), the bandwidth roof below the ridge point peak / bandwidth, the flat roof above
+// the file has one line per thread count, the STREAM bandwidths and the peaks of that many threads in double and in
+// single precision (a vector holds twice as many floats), # starts a comment
+//   # threads copy_gbs scale_gbs add_gbs triad_gbs gflops gflops_float
+//   1 11.2 11.0 12.4 12.5 15.8 31.5
+// HPC_ROOFLINE names the file, roofline.txt in the working directory otherwise
+//   roofline::summary roof;
+//   if (roof.load())
+//       std::cout << roofline::percent(roof.percent_of_bandwidth(gbs, threads));
+
+namespace roofline
+{
+    enum precision
+    {
+        double_precision,
+        single_precision
+    };
+
+    struct point
+    {
+        int threads = 0;
+        double copy = 0, scale = 0, add = 0, triad = 0; // GB/s
+        double gflops = 0, gflops_float = 0;
+
+        double peak(precision p) const { return p == single_precision ? gflops_float : gflops; }
+
+        // the best the memory did for any of the kernels
+        double bandwidth() const { return std::max(std::max(copy, scale), std::max(add, triad)); }
+    };
+
+    inline std::string default_path()
+    {
+        const char *path = std::getenv("HPC_ROOFLINE");
+        return path && *path ? path : "roofline.txt";
+    }
+
+    class summary
+    {
+    public:
+        void add(const point &p)
+        {
+            points_.push_back(p);
+            std::sort(points_.begin(), points_.end(), [](const point &a, const point &b) { return a.threads < b.threads; });
+        }
+
+        bool empty() const { return points_.empty(); }
+        const std::vector<point> &points() const { return points_; }
+
+        // false when the file is missing or has no thread counts
+        bool load(const std::string &path = default_path())
+        {
+            std::ifstream in(path);
+            std::string line;
+            while (std::getline(in, line))
+            {
+                if (line.empty() || line[0] == '#')
+                    continue;
+                std::istringstream fields(line);
+                point p;
+                if (fields >> p.threads >> p.copy >> p.scale >> p.add >> p.triad >> p.gflops >> p.gflops_float)
+                    add(p);
+            }
+            return !empty();
+        }
+
+        bool save(const std::string &path = default_path()) const
+        {
+            std::ofstream out(path);
+            out << "# roofline written by HPC_CPP/1.e.roofline, read by common/roofline.h\n"
+                << "# threads copy_gbs scale_gbs add_gbs triad_gbs gflops gflops_float\n";
+            for (const point &p : points_)
+                out << p.threads << " " << p.copy << " " << p.scale << " " << p.add << " " << p.triad << " " << p.gflops
+                    << " " << p.gflops_float << "\n";
+            return static_cast<bool>(out);
+        }
+
+        // the measurement with the most threads up to threads, the fewest measured if there is none
+        // a run on 3 threads compares with the roof of 2 rather than of 4, which it could not reach
+        const point &at(int threads) const
+        {
+            const point *best = &points_.front();
+            for (const point &p : points_)
+                if (p.threads <= threads)
+                    best = &p;
+            return *best;
+        }
+
+        // min(peak, intensity * bandwidth) in GFLOP/s, intensity in flops per byte
+        double attainable(double intensity, int threads, precision pr = double_precision) const
+        {
+            const point &p = at(threads);
+            return std::min(p.peak(pr), intensity * p.bandwidth());
+        }
+
+        // the percentages are NaN without a roofline, percent() prints them as an empty CSV field
+        double percent_of_bandwidth(double gbs, int threads) const
+        {
+            return empty() ? std::numeric_limits<double>::quiet_NaN() : 100.0 * gbs / at(threads).bandwidth();
+        }
+
+        double percent_of_peak(double gflops, int threads, precision pr = double_precision) const
+        {
+            return empty() ? std::numeric_limits<double>::quiet_NaN() : 100.0 * gflops / at(threads).peak(pr);
+        }
+
+        double percent_of_roof(double gflops, double intensity, int threads, precision pr = double_precision) const
+        {
+            return empty() ? std::numeric_limits<double>::quiet_NaN()
+                           : 100.0 * gflops / attainable(intensity, threads, pr);
+        }
+
+    private:
+        std::vector<point> points_;
+    };
+
+    inline std::string percent(double value)
+    {
+        if (std::isnan(value))
+            return "";
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.1f", value);
+        return text;
+    }
+}
+
+#endif
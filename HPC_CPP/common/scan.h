@@ -0,0 +1,209 @@
+#ifndef scan_h
+#define scan_h
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include <omp.h>
+#include <per_thread.h>
+
+// parallel prefix scans over arrays, for any associative operator op with an identity (op(identity, x) == x)
+//   scan::inclusive_scan(in, out, n)                       out[i] = in[0] + ... + in[i]
+//   scan::exclusive_scan(in, out, n, init)                 out[i] = init + in[0] + ... + in[i - 1]
+//   scan::inclusive_scan(in, out, n, op, identity)         the same with op instead of +
+// in and out may be the same array
+// two implementations:
+//   directive  the OpenMP 5 scan directive, #pragma omp for reduction(inscan, ...) and #pragma omp scan, where the
+//              compiler has it (GCC 10, clang 11 and later), for commutative operators that can be default-constructed,
+//              since an OpenMP reduction may combine the partial results in any order
+//   blocked    two passes per block of the array that fits in the caches: every thread reduces its part of the block,
+//              then scans it again starting from the reductions of the threads before it, while it is still cached
+//              any associative operator, commutative or not
+// inclusive_scan and exclusive_scan take the directive where they may, and the blocked scan otherwise
+
+#if _OPENMP >= 201811 || (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 10)
+#define SCAN_HAVE_DIRECTIVE 1
+#else
+#define SCAN_HAVE_DIRECTIVE 0
+#endif
+
+namespace scan
+{
+    // operators whose operands may be swapped, specialize it for your own
+    template <typename Op>
+    struct is_commutative : std::false_type
+    {
+    };
+    template <typename T>
+    struct is_commutative<std::plus<T>> : std::true_type
+    {
+    };
+    template <typename T>
+    struct is_commutative<std::multiplies<T>> : std::true_type
+    {
+    };
+    template <typename T>
+    struct is_commutative<std::bit_and<T>> : std::true_type
+    {
+    };
+    template <typename T>
+    struct is_commutative<std::bit_or<T>> : std::true_type
+    {
+    };
+    template <typename T>
+    struct is_commutative<std::bit_xor<T>> : std::true_type
+    {
+    };
+
+    template <typename Op>
+    constexpr bool directive_applies = SCAN_HAVE_DIRECTIVE && is_commutative<Op>::value &&
+                                       std::is_default_constructible<Op>::value;
+
+    // elements per thread and block, a quarter of a typical L2, so that the second pass reads from the cache
+    template <typename T>
+    constexpr std::size_t block_elements = std::max<std::size_t>(1, (std::size_t(1) << 18) / sizeof(T));
+
+    // below this many elements per thread, the parallel region costs more than it saves
+    constexpr std::size_t min_per_thread = 1 << 14;
+
+    inline int threads_for(std::size_t n, int threads)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        return static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(threads, n / min_per_thread)));
+    }
+
+    // inclusive when init is empty, exclusive from init otherwise
+    template <typename T, typename Op>
+    void blocked(const T *in, T *out, std::size_t n, Op op, const T &identity, const T *init, int threads)
+    {
+        threads = threads_for(n, threads);
+        // the reductions of the threads, two sets so that a thread can start the next block while a slower
+        // one still reads the last one's
+        std::vector<padded<T>> partials(2 * static_cast<std::size_t>(threads), padded<T>(identity));
+#pragma omp parallel num_threads(threads)
+        {
+            const int t = omp_get_thread_num(), count = omp_get_num_threads();
+            const std::size_t step = block_elements<T> * static_cast<std::size_t>(count);
+            T carry = init ? *init : identity; // everything before the block
+            for (std::size_t base = 0, round = 0; base < n; base += step, round++)
+            {
+                const std::size_t size = std::min(step, n - base);
+                const std::size_t begin = base + size * t / count, end = base + size * (t + 1) / count;
+                padded<T> *partial = partials.data() + (round % 2) * count;
+
+                T sum = identity;
+                for (std::size_t i = begin; i < end; i++)
+                    sum = op(sum, in[i]);
+                partial[t].value = sum;
+#pragma omp barrier
+                T running = carry;
+                for (int k = 0; k < t; k++)
+                    running = op(running, partial[k].value);
+                for (int k = 0; k < count; k++)
+                    carry = op(carry, partial[k].value);
+                if (init)
+                {
+                    for (std::size_t i = begin; i < end; i++)
+                    {
+                        const T value = in[i]; // in may be out
+                        out[i] = running;
+                        running = op(running, value);
+                    }
+                }
+                else
+                {
+                    for (std::size_t i = begin; i < end; i++)
+                    {
+                        running = op(running, in[i]);
+                        out[i] = running;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T, typename Op = std::plus<T>>
+    void blocked_inclusive_scan(const T *in, T *out, std::size_t n, Op op = Op(), T identity = T(), int threads = 0)
+    {
+        blocked(in, out, n, op, identity, static_cast<const T *>(nullptr), threads);
+    }
+
+    template <typename T, typename Op = std::plus<T>>
+    void blocked_exclusive_scan(const T *in, T *out, std::size_t n, T init, Op op = Op(), T identity = T(),
+                                int threads = 0)
+    {
+        blocked(in, out, n, op, identity, &init, threads);
+    }
+
+#if SCAN_HAVE_DIRECTIVE
+    // the private copies of x start from x itself, which holds the identity, the combiner calls a fresh Op
+    template <typename T, typename Op = std::plus<T>>
+    void directive_inclusive_scan(const T *in, T *out, std::size_t n, Op op = Op(), T identity = T(), int threads = 0)
+    {
+        static_assert(directive_applies<Op>, "the scan directive needs a commutative, default-constructible operator");
+        const long long count = static_cast<long long>(n);
+        T x = identity;
+#pragma omp declare reduction(scan_op : T : omp_out = Op()(omp_out, omp_in)) initializer(omp_priv = omp_orig)
+#pragma omp parallel for reduction(inscan, scan_op : x) num_threads(threads_for(n, threads))
+        for (long long i = 0; i < count; i++)
+        {
+            x = op(x, in[i]);
+#pragma omp scan inclusive(x)
+            out[i] = x;
+        }
+    }
+
+    // init joins every element rather than the private copies, which must start from the identity
+    // the two halves of the body are separate blocks, so in must not be out
+    template <typename T, typename Op = std::plus<T>>
+    void directive_exclusive_scan(const T *in, T *out, std::size_t n, T init, Op op = Op(), T identity = T(),
+                                  int threads = 0)
+    {
+        static_assert(directive_applies<Op>, "the scan directive needs a commutative, default-constructible operator");
+        const long long count = static_cast<long long>(n);
+        T x = identity;
+#pragma omp declare reduction(scan_op : T : omp_out = Op()(omp_out, omp_in)) initializer(omp_priv = omp_orig)
+#pragma omp parallel for reduction(inscan, scan_op : x) num_threads(threads_for(n, threads))
+        for (long long i = 0; i < count; i++)
+        {
+            out[i] = op(init, x);
+#pragma omp scan exclusive(x)
+            x = op(x, in[i]);
+        }
+    }
+#endif
+
+    template <typename T, typename Op = std::plus<T>>
+    void inclusive_scan(const T *in, T *out, std::size_t n, Op op = Op(), T identity = T(), int threads = 0)
+    {
+#if SCAN_HAVE_DIRECTIVE
+        if constexpr (directive_applies<Op>)
+        {
+            directive_inclusive_scan(in, out, n, op, identity, threads);
+            return;
+        }
+#endif
+        blocked_inclusive_scan(in, out, n, op, identity, threads);
+    }
+
+    template <typename T, typename Op = std::plus<T>>
+    void exclusive_scan(const T *in, T *out, std::size_t n, T init, Op op = Op(), T identity = T(), int threads = 0)
+    {
+#if SCAN_HAVE_DIRECTIVE
+        if constexpr (directive_applies<Op>)
+        {
+            if (in != out)
+            {
+                directive_exclusive_scan(in, out, n, init, op, identity, threads);
+                return;
+            }
+        }
+#endif
+        blocked_exclusive_scan(in, out, n, init, op, identity, threads);
+    }
+}
+
+#endif
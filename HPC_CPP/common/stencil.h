@@ -0,0 +1,247 @@
+#ifndef stencil_h
+#define stencil_h
+
+#include <algorithm>
+#include <cstddef>
+#include <omp.h>
+
+// iterative stencil sweeps over a 2D or 3D grid, every interior cell becomes the mean of its 4 (2D) or 6 (3D)
+// neighbours, the cells on the faces are fixed (Dirichlet boundary)
+// two methods:
+//   jacobi     every sweep reads u and writes v, then the two swap, all cells of a sweep are independent
+//   red_black  Gauss-Seidel in place, in two half-sweeps: the red cells ((x + y + z) even) from their black
+//              neighbours, then the black ones from the new red ones, the cells of a half-sweep are independent
+// a level is one sweep of jacobi or one half-sweep of red_black, every variant runs the same levels in the same
+// order and computes the same values
+// three variants:
+//   naive      one parallel loop over the outermost dimension (rows in 2D, planes in 3D) per level
+//   tiled      spatial blocking: per level, tiles of tile_y rows by tile_x columns (in 3D each tile runs through
+//              all planes), small enough that the neighbour rows of a tile stay in the cache while it is swept
+//   wavefront  temporal blocking: depth sweeps in one pass over the grid, level s runs 2 * s rows (planes)
+//              behind level s - 1, so it finds the rows it needs still in the cache, and the grid comes from memory
+//              once per depth sweeps instead of once per sweep
+//              the 2 rows of skew make the levels of one position independent: a row only needs rows that earlier
+//              positions finished, so the threads split every row (the columns in 2D, the rows of the plane in 3D)
+//              and meet at one barrier per position; jacobi gets by with u and v, as no level overwrites a row
+//              that a later position still reads
+// the inner loops are omp simd over x, the red_black ones with a stride of 2
+//   stencil::grid g{nx, ny, 1};            // nz = 1 for 2D
+//   double *result = stencil::wavefront(stencil::method::jacobi, g, u, v, sweeps, 8);
+
+namespace stencil
+{
+    enum class method
+    {
+        jacobi,
+        red_black
+    };
+
+    struct grid
+    {
+        int nx, ny, nz; // nz = 1 for a 2D grid
+
+        int dims() const { return nz > 1 ? 3 : 2; }
+        std::size_t size() const { return std::size_t(nx) * ny * nz; }
+        std::size_t index(int x, int y, int z) const { return (std::size_t(z) * ny + y) * nx + x; }
+
+        // the outermost dimension, which naive splits and wavefront skews
+        int outer() const { return nz > 1 ? nz : ny; }
+        std::size_t interior() const
+        {
+            return std::size_t(nx - 2) * std::size_t(ny - 2) * (nz > 1 ? std::size_t(nz - 2) : 1);
+        }
+    };
+
+    // interior cells [x0, x1) x [y0, y1) x [z0, z1), in 2D z is [0, 1)
+    struct box
+    {
+        int x0, x1, y0, y1, z0, z1;
+    };
+
+    inline int levels_per_sweep(method m) { return m == method::jacobi ? 1 : 2; }
+
+    template <int Dims>
+    void jacobi_box(const double *in, double *out, const grid &g, const box &b)
+    {
+        const std::ptrdiff_t row = g.nx, plane = std::ptrdiff_t(g.nx) * g.ny;
+        for (int z = b.z0; z < b.z1; z++)
+        {
+            for (int y = b.y0; y < b.y1; y++)
+            {
+                const double *c = in + g.index(0, y, z);
+                double *o = out + g.index(0, y, z);
+                if constexpr (Dims == 2)
+                {
+#pragma omp simd
+                    for (int x = b.x0; x < b.x1; x++)
+                        o[x] = 0.25 * (c[x - 1] + c[x + 1] + c[x - row] + c[x + row]);
+                }
+                else
+                {
+#pragma omp simd
+                    for (int x = b.x0; x < b.x1; x++)
+                        o[x] = (1.0 / 6.0) * (c[x - 1] + c[x + 1] + c[x - row] + c[x + row] + c[x - plane] + c[x + plane]);
+                }
+            }
+        }
+    }
+
+    // the cells of one color only, their neighbours all have the other one
+    template <int Dims>
+    void red_black_box(double *u, const grid &g, const box &b, int color)
+    {
+        const std::ptrdiff_t row = g.nx, plane = std::ptrdiff_t(g.nx) * g.ny;
+        for (int z = b.z0; z < b.z1; z++)
+        {
+            for (int y = b.y0; y < b.y1; y++)
+            {
+                double *c = u + g.index(0, y, z);
+                const int first = b.x0 + ((b.x0 + y + z + color) & 1);
+                if constexpr (Dims == 2)
+                {
+#pragma omp simd
+                    for (int x = first; x < b.x1; x += 2)
+                        c[x] = 0.25 * (c[x - 1] + c[x + 1] + c[x - row] + c[x + row]);
+                }
+                else
+                {
+#pragma omp simd
+                    for (int x = first; x < b.x1; x += 2)
+                        c[x] = (1.0 / 6.0) * (c[x - 1] + c[x + 1] + c[x - row] + c[x + row] + c[x - plane] + c[x + plane]);
+                }
+            }
+        }
+    }
+
+    // level l reads u and writes v when even (jacobi), or updates the red cells when even (red_black)
+    template <int Dims>
+    void level_box(method m, double *u, double *v, const grid &g, const box &b, long long level)
+    {
+        if (m == method::jacobi)
+        {
+            if (level % 2 == 0)
+                jacobi_box<Dims>(u, v, g, b);
+            else
+                jacobi_box<Dims>(v, u, g, b);
+        }
+        else
+            red_black_box<Dims>(u, g, b, static_cast<int>(level % 2));
+    }
+
+    // the interior slice of the outermost dimension at o
+    inline box slice(const grid &g, int o)
+    {
+        return g.dims() == 2 ? box{1, g.nx - 1, o, o + 1, 0, 1} : box{1, g.nx - 1, 1, g.ny - 1, o, o + 1};
+    }
+
+    // the array with the latest values, u or v
+    inline double *result(method m, double *u, double *v, long long levels)
+    {
+        return m == method::jacobi && levels % 2 == 1 ? v : u;
+    }
+
+    template <int Dims>
+    double *naive_sweeps(method m, const grid &g, double *u, double *v, int sweeps, int threads)
+    {
+        const long long levels = static_cast<long long>(sweeps) * levels_per_sweep(m);
+#pragma omp parallel num_threads(threads)
+        for (long long l = 0; l < levels; l++)
+        {
+            // the barrier at the end of the loop orders the levels
+#pragma omp for schedule(static)
+            for (int o = 1; o < g.outer() - 1; o++)
+                level_box<Dims>(m, u, v, g, slice(g, o), l);
+        }
+        return result(m, u, v, levels);
+    }
+
+    template <int Dims>
+    double *tiled_sweeps(method m, const grid &g, double *u, double *v, int sweeps, int tile_y, int tile_x, int threads)
+    {
+        const long long levels = static_cast<long long>(sweeps) * levels_per_sweep(m);
+        const int tiles_y = (g.ny - 2 + tile_y - 1) / tile_y, tiles_x = (g.nx - 2 + tile_x - 1) / tile_x;
+        const int z0 = Dims == 2 ? 0 : 1, z1 = Dims == 2 ? 1 : g.nz - 1;
+#pragma omp parallel num_threads(threads)
+        for (long long l = 0; l < levels; l++)
+        {
+#pragma omp for collapse(2) schedule(static)
+            for (int ty = 0; ty < tiles_y; ty++)
+            {
+                for (int tx = 0; tx < tiles_x; tx++)
+                {
+                    const int y0 = 1 + ty * tile_y, x0 = 1 + tx * tile_x;
+                    const box b{x0, std::min(x0 + tile_x, g.nx - 1), y0, std::min(y0 + tile_y, g.ny - 1), z0, z1};
+                    level_box<Dims>(m, u, v, g, b, l);
+                }
+            }
+        }
+        return result(m, u, v, levels);
+    }
+
+    template <int Dims>
+    double *wavefront_sweeps(method m, const grid &g, double *u, double *v, int sweeps, int depth, int threads)
+    {
+        const long long levels = static_cast<long long>(sweeps) * levels_per_sweep(m);
+        const long long block = static_cast<long long>(std::max(depth, 1)) * levels_per_sweep(m);
+        const int outer = g.outer();
+#pragma omp parallel num_threads(threads)
+        {
+            // the static share of this thread in every row (plane): columns in 2D, rows of the plane in 3D
+            const int t = omp_get_thread_num(), team = omp_get_num_threads();
+            const int inner = Dims == 2 ? g.nx - 2 : g.ny - 2;
+            const int begin = 1 + static_cast<int>(static_cast<long long>(inner) * t / team);
+            const int end = 1 + static_cast<int>(static_cast<long long>(inner) * (t + 1) / team);
+            for (long long first = 0; first < levels; first += block)
+            {
+                const int count = static_cast<int>(std::min(block, levels - first));
+                // position p: level s of the block updates row p - 2 * s
+                for (int p = 1; p < outer - 1 + 2 * (count - 1); p++)
+                {
+                    for (int s = 0; s < count; s++)
+                    {
+                        const int o = p - 2 * s;
+                        if (o < 1 || o >= outer - 1)
+                            continue;
+                        box b = slice(g, o);
+                        if (Dims == 2)
+                            b.x0 = begin, b.x1 = end;
+                        else
+                            b.y0 = begin, b.y1 = end;
+                        level_box<Dims>(m, u, v, g, b, first + s);
+                    }
+#pragma omp barrier
+                }
+            }
+        }
+        return result(m, u, v, levels);
+    }
+
+    // sweeps over u (and v for jacobi), both hold the same initial grid, the boundary included
+    // they return the array with the result
+    inline double *naive(method m, const grid &g, double *u, double *v, int sweeps, int threads = 0)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        return g.dims() == 2 ? naive_sweeps<2>(m, g, u, v, sweeps, threads)
+                             : naive_sweeps<3>(m, g, u, v, sweeps, threads);
+    }
+
+    inline double *tiled(method m, const grid &g, double *u, double *v, int sweeps, int tile_y, int tile_x,
+                         int threads = 0)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        return g.dims() == 2 ? tiled_sweeps<2>(m, g, u, v, sweeps, tile_y, tile_x, threads)
+                             : tiled_sweeps<3>(m, g, u, v, sweeps, tile_y, tile_x, threads);
+    }
+
+    inline double *wavefront(method m, const grid &g, double *u, double *v, int sweeps, int depth, int threads = 0)
+    {
+        if (threads <= 0)
+            threads = omp_get_max_threads();
+        return g.dims() == 2 ? wavefront_sweeps<2>(m, g, u, v, sweeps, depth, threads)
+                             : wavefront_sweeps<3>(m, g, u, v, sweeps, depth, threads);
+    }
+}
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef sync_h
+#define sync_h
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <per_thread.h>
+#include <thread_pool.h>
+
+// barriers and spin locks built from atomics, to compare with #pragma omp barrier and #pragma omp critical
+// barriers: a fixed team of threads numbered 0 .. threads - 1, every thread calls wait(thread) once per episode
+//   sense_barrier          one counter and one flag, every arrival writes the same line
+//   dissemination_barrier  log2(threads) rounds, in round r thread i signals thread i + 2^r, no thread waits on a
+//                          shared line, no thread is special
+//   tournament_barrier     pairs of threads meet in log2(threads) rounds, the winner goes on, thread 0 wins the
+//                          tournament and wakes the losers down the same tree
+// locks: lock() and unlock(), usable with std::lock_guard, except mcs_lock which needs a queue node per acquisition
+//   ttas_lock    spins reading a flag, only tries to take it when it looks free
+//   ticket_lock  takes a number and waits for its turn, first come first served
+//   mcs_lock     a queue of nodes, every waiter spins on its own node, the holder hands the lock to the next one
+// every flag a thread spins on is padded to its own cache line (per_thread.h), padded<> value-initializes, so the
+// atomics start at 0, false and nullptr
+
+// spins with the pause hint while ready() is false, then yields: with more threads than hardware threads the
+// thread that is waited for may need this one's core
+template <typename Ready>
+void spin_wait(Ready ready)
+{
+    for (int i = 0; !ready(); i++)
+    {
+        if (i < 1000)
+            cpu_relax();
+        else
+            std::this_thread::yield();
+    }
+}
+
+class sense_barrier
+{
+public:
+    explicit sense_barrier(int threads) : threads_(threads), sense_(threads, false) {}
+
+    void wait(int thread)
+    {
+        // the flag alternates between episodes, so a thread still leaving the last one cannot mix them up
+        const bool sense = sense_[thread] = !sense_[thread];
+        if (count_.value.fetch_add(1, std::memory_order_acq_rel) + 1 == threads_)
+        {
+            count_.value.store(0, std::memory_order_relaxed);
+            flag_.value.store(sense, std::memory_order_release);
+            return;
+        }
+        spin_wait([&] { return flag_.value.load(std::memory_order_acquire) == sense; });
+    }
+
+private:
+    const int threads_;
+    per_thread<bool> sense_;
+    padded<std::atomic<int>> count_;
+    padded<std::atomic<bool>> flag_;
+};
+
+class dissemination_barrier
+{
+public:
+    explicit dissemination_barrier(int threads) : threads_(threads), episode_(threads, 0u)
+    {
+        while ((1 << rounds_) < threads_)
+            rounds_++;
+        flags_ = std::vector<padded<std::atomic<unsigned>>>(static_cast<std::size_t>(threads_) * rounds_);
+    }
+
+    void wait(int thread)
+    {
+        // flags count the signals of every episode, a partner that runs ahead into the next episode adds one more
+        // and does not undo this one
+        const unsigned episode = ++episode_[thread];
+        for (int r = 0; r < rounds_; r++)
+        {
+            const int partner = (thread + (1 << r)) % threads_;
+            flag(partner, r).fetch_add(1, std::memory_order_release);
+            std::atomic<unsigned> &mine = flag(thread, r);
+            spin_wait([&] { return mine.load(std::memory_order_acquire) >= episode; });
+        }
+    }
+
+private:
+    std::atomic<unsigned> &flag(int thread, int round) { return flags_[thread * rounds_ + round].value; }
+
+    const int threads_;
+    int rounds_ = 0;
+    per_thread<unsigned> episode_;
+    std::vector<padded<std::atomic<unsigned>>> flags_;
+};
+
+class tournament_barrier
+{
+public:
+    explicit tournament_barrier(int threads)
+        : threads_(threads), episode_(threads, 0u), arrived_(threads), released_(threads)
+    {
+    }
+
+    void wait(int thread)
+    {
+        const unsigned episode = ++episode_[thread];
+        // up the tree: in round r, thread i with i % 2^(r+1) == 0 waits for thread i + 2^r, which then drops out
+        // every thread loses at most once, so it has one arrival flag, written by itself and read by its winner
+        int round = 0;
+        for (; (1 << round) < threads_; round++)
+        {
+            const int step = 1 << round;
+            if (thread & step)
+            {
+                arrived_[thread].value.store(episode, std::memory_order_release);
+                spin_wait([&] { return released_[thread].value.load(std::memory_order_acquire) == episode; });
+                break;
+            }
+            if (thread + step < threads_)
+            {
+                std::atomic<unsigned> &loser = arrived_[thread + step].value;
+                spin_wait([&] { return loser.load(std::memory_order_acquire) == episode; });
+            }
+        }
+        // down the tree: wake the threads this one beat, the last round first
+        for (int r = round - 1; r >= 0; r--)
+        {
+            const int loser = thread + (1 << r);
+            if (loser < threads_)
+                released_[loser].value.store(episode, std::memory_order_release);
+        }
+    }
+
+private:
+    const int threads_;
+    per_thread<unsigned> episode_;
+    std::vector<padded<std::atomic<unsigned>>> arrived_, released_;
+};
+
+class ttas_lock
+{
+public:
+    void lock()
+    {
+        for (;;)
+        {
+            // reading keeps the line shared in every waiter's cache, only the exchange takes it exclusively
+            spin_wait([&] { return !locked_.value.load(std::memory_order_relaxed); });
+            if (!locked_.value.exchange(true, std::memory_order_acquire))
+                return;
+        }
+    }
+
+    void unlock() { locked_.value.store(false, std::memory_order_release); }
+
+private:
+    padded<std::atomic<bool>> locked_;
+};
+
+class ticket_lock
+{
+public:
+    void lock()
+    {
+        const unsigned ticket = next_.value.fetch_add(1, std::memory_order_relaxed);
+        spin_wait([&] { return serving_.value.load(std::memory_order_acquire) == ticket; });
+    }
+
+    void unlock()
+    {
+        serving_.value.store(serving_.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    padded<std::atomic<unsigned>> next_, serving_;
+};
+
+class mcs_lock
+{
+public:
+    // one per acquisition, on the stack of the thread that waits on it
+    struct alignas(cache_line) node
+    {
+        std::atomic<node *> next{nullptr};
+        std::atomic<bool> waiting{false};
+    };
+
+    void lock(node &mine)
+    {
+        mine.next.store(nullptr, std::memory_order_relaxed);
+        mine.waiting.store(true, std::memory_order_relaxed);
+        node *before = tail_.value.exchange(&mine, std::memory_order_acq_rel);
+        if (!before)
+            return;
+        before->next.store(&mine, std::memory_order_release);
+        spin_wait([&] { return !mine.waiting.load(std::memory_order_acquire); });
+    }
+
+    void unlock(node &mine)
+    {
+        node *next = mine.next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            // nobody queued behind this node: free the lock, unless a thread swapped itself in meanwhile
+            node *expected = &mine;
+            if (tail_.value.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+                return;
+            // that thread has yet to link itself behind this node
+            spin_wait([&] { return (next = mine.next.load(std::memory_order_acquire)) != nullptr; });
+        }
+        next->waiting.store(false, std::memory_order_release);
+    }
+
+    // lock() to unlock() of one scope, like std::lock_guard
+    class guard
+    {
+    public:
+        explicit guard(mcs_lock &lock) : lock_(lock) { lock_.lock(node_); }
+        ~guard() { lock_.unlock(node_); }
+
+        guard(const guard &) = delete;
+        guard &operator=(const guard &) = delete;
+
+    private:
+        mcs_lock &lock_;
+        node node_;
+    };
+
+private:
+    padded<std::atomic<node *>> tail_;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef thread_pool_h
+#define thread_pool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <per_thread.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// a pool of persistent threads for many small parallel regions
+//   thread_pool pool(8);
+//   pool.run([&](int thread) { ... pool.barrier(); ... });   // thread 0 is the caller
+// waiting threads spin for `spin` rounds, which catches the next region without a system call when regions
+// follow each other closely, and then park on a condition variable, so that an idle pool costs no CPU time
+// with more threads than hardware threads a spinning thread only delays the one it waits for, so the pool does not
+// spin at all then, like libgomp with its throttled spin count
+// an OpenMP runtime does the same, tuned with OMP_WAIT_POLICY and implementation specific variables
+// (GOMP_SPINCOUNT, KMP_BLOCKTIME), the pool makes the trade-off visible in one place
+
+// a hint to the core that this is a spin loop, so that it saves power and frees resources for a sibling thread
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+class thread_pool
+{
+public:
+    explicit thread_pool(int threads = static_cast<int>(std::thread::hardware_concurrency()), int spin = 4000)
+        : size_(threads > 0 ? threads : 1),
+          spin_(static_cast<unsigned>(size_) > std::thread::hardware_concurrency() ? 0 : spin)
+    {
+        for (int id = 1; id < size_; id++)
+            workers_.emplace_back([this, id] { work(id); });
+    }
+
+    ~thread_pool()
+    {
+        stop_ = true;
+        start([](void *, int) {}, nullptr);
+        for (std::thread &t : workers_)
+            t.join();
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    int size() const { return size_; }
+
+    // f(thread) on every thread of the pool, f(0) on the caller, returns when every call returned
+    template <typename F>
+    void run(F &&f)
+    {
+        using Fn = typename std::remove_reference<F>::type;
+        start([](void *context, int thread) { (*static_cast<Fn *>(context))(thread); }, &f);
+        f(0);
+        // wait for the workers: spin, then park until the last one notifies
+        for (int i = 0; pending_.value.load(std::memory_order_acquire) != 0; i++)
+        {
+            if (i < spin_)
+            {
+                cpu_relax();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            caller_parked_ = true;
+            done_.wait(lock, [&] { return pending_.value.load() == 0; });
+            caller_parked_ = false;
+            break;
+        }
+    }
+
+    // inside run(): returns once every thread of the pool has called it
+    // spins, then yields, a barrier never parks since the other threads are expected within the same region
+    void barrier()
+    {
+        const unsigned phase = barrier_phase_.value.load(std::memory_order_acquire);
+        if (arrived_.value.fetch_add(1, std::memory_order_acq_rel) + 1 == size_)
+        {
+            arrived_.value.store(0, std::memory_order_relaxed);
+            barrier_phase_.value.store(phase + 1, std::memory_order_release);
+            return;
+        }
+        for (int i = 0; barrier_phase_.value.load(std::memory_order_acquire) == phase; i++)
+        {
+            if (i < spin_)
+                cpu_relax();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    void start(void (*call)(void *, int), void *context)
+    {
+        call_ = call;
+        context_ = context;
+        pending_.value.store(size_ - 1, std::memory_order_relaxed);
+        // seq_cst on the generation and on sleepers_: either the parking worker sees the new generation,
+        // or this thread sees the worker asleep and notifies it
+        generation_.value.fetch_add(1);
+        if (sleepers_.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_.notify_all();
+        }
+    }
+
+    void work(int id)
+    {
+        unsigned seen = 0;
+        for (;;)
+        {
+            unsigned generation = generation_.value.load(std::memory_order_acquire);
+            for (int i = 0; generation == seen && i < spin_; i++)
+            {
+                cpu_relax();
+                generation = generation_.value.load(std::memory_order_acquire);
+            }
+            if (generation == seen)
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                sleepers_++;
+                wake_.wait(lock, [&] { return generation_.value.load() != seen; });
+                sleepers_--;
+                generation = generation_.value.load();
+            }
+            seen = generation;
+            if (stop_)
+                return;
+
+            call_(context_, id);
+            if (pending_.value.fetch_sub(1) == 1 && caller_parked_.load())
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.notify_one();
+            }
+        }
+    }
+
+    const int size_, spin_;
+    std::vector<std::thread> workers_;
+
+    // written by the caller before the generation changes, read by the workers after they saw it change
+    void (*call_)(void *, int) = nullptr;
+    void *context_ = nullptr;
+    bool stop_ = false;
+
+    padded<std::atomic<unsigned>> generation_;
+    padded<std::atomic<int>> pending_;
+    padded<std::atomic<int>> arrived_;
+    padded<std::atomic<unsigned>> barrier_phase_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> caller_parked_{false};
+};
+
+#endif